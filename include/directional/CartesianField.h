@@ -18,35 +18,40 @@
  they are represented by Cartesian coordinates (intrinsically and possibly extrinsically). The class supports either direct raw fields (just a list of vectors in each
  tangent space in order), or power and polyvector fields, representing fields as root of polynomials irrespective of order.
 
- This class assumes extrinsic representation in 3D space.
+ This class assumes extrinsic representation in 3D space. The field is of type Scalar, on a tangent bundle of the same type; CartesianField is the double-precision field.
  ***/
 
 namespace directional{
 
     enum class fieldTypeEnum{RAW_FIELD, POWER_FIELD, POLYVECTOR_FIELD};
 
-    class CartesianField{
+    template<typename Scalar>
+    class CartesianFieldT{
     public:
 
-        const TangentBundle* tb;            //Referencing the tangent bundle on which the field is defined
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixXs;
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorXs;
+        typedef Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, Eigen::Dynamic> MatrixXcs;
+
+        const TangentBundleT<Scalar>* tb;            //Referencing the tangent bundle on which the field is defined
 
         int N;                              //Degree of field (how many vectors are in each point);
         fieldTypeEnum fieldType;                      //The representation of the field (for instance, either a raw field or a power/polyvector field)
 
-        Eigen::MatrixXd intField;           //Intrinsic representation (depending on the local basis of the face). Size #T x 2N
-        Eigen::MatrixXd extField;           //Ambient coordinates. Size Size #T x 3N
+        MatrixXs intField;                  //Intrinsic representation (depending on the local basis of the face). Size #T x 2N
+        MatrixXs extField;                  //Ambient coordinates. Size Size #T x 3N
 
         Eigen::VectorXi matching;           //Matching(i)=j when vector k in adjSpaces(i,0) matches to vector (k+j)%N in adjSpaces(i,1)
-        Eigen::VectorXd effort;             //Effort of the entire matching (sum of deviations from parallel transport)
+        VectorXs effort;                    //Effort of the entire matching (sum of deviations from parallel transport)
         Eigen::VectorXi singLocalCycles;    //Singular (dual elements). Only the local cycles! not the generators or boundary cycles
         Eigen::VectorXi singIndices;        //Corresponding indices (this is the numerator where the true fractional index is singIndices/N);
 
-        CartesianField(){}
-        CartesianField(const TangentBundle& _tb):tb(&_tb){}
-        ~CartesianField(){}
+        CartesianFieldT(){}
+        CartesianFieldT(const TangentBundleT<Scalar>& _tb):tb(&_tb){}
+        ~CartesianFieldT(){}
 
         //Initializing the field with the proper tangent spaces
-        void IGL_INLINE init(const TangentBundle& _tb, const fieldTypeEnum _fieldType, const int _N){
+        void IGL_INLINE init(const TangentBundleT<Scalar>& _tb, const fieldTypeEnum _fieldType, const int _N){
             tb = &_tb;
             fieldType = _fieldType;
             N=_N;
@@ -54,7 +59,7 @@ namespace directional{
             extField.resize(tb->sources.rows(),3*N);
         };
 
-        void IGL_INLINE set_intrinsic_field(const Eigen::MatrixXd& _intField){
+        void IGL_INLINE set_intrinsic_field(const MatrixXs& _intField){
             assert (!(fieldType==fieldTypeEnum::POWER_FIELD) || (_intField.cols()==2));
             assert ((_intField.cols()==2*N) || !(fieldType==fieldTypeEnum::POLYVECTOR_FIELD || fieldType==fieldTypeEnum::RAW_FIELD));
             intField = _intField;
@@ -63,7 +68,7 @@ namespace directional{
         }
 
         //The same, just with complex coordinates
-        void virtual IGL_INLINE set_intrinsic_field(const Eigen::MatrixXcd& _intField){
+        void virtual IGL_INLINE set_intrinsic_field(const MatrixXcs& _intField){
             intField.resize(_intField.rows(),_intField.cols()*2);
             for (int i=0;i<N;i++){
                 intField.col(2*i)=_intField.col(i).real();
@@ -73,7 +78,7 @@ namespace directional{
         }
 
         //Setting the field by the extrinsic ambient field, which will get projected to the intrinsic tangent spaces.
-        void IGL_INLINE set_extrinsic_field(const Eigen::MatrixXd& _extField){
+        void IGL_INLINE set_extrinsic_field(const MatrixXs& _extField){
             assert(_extField.cols()==3*N);
             extField=_extField;
             intField = tb->project_to_intrinsic(Eigen::VectorXi::LinSpaced(extField.rows(), 0,extField.rows()-1), extField);
@@ -90,6 +95,8 @@ namespace directional{
         }
     };
 
+    typedef CartesianFieldT<double> CartesianField;
+
 }
 
 
@@ -12,7 +12,9 @@
 #include <igl/igl_inline.h>
 #include <Eigen/Core>
 #include <Eigen/Sparse>
+#include <Eigen/Eigenvalues>
 #include <igl/dot_row.h>
+#include <igl/parallel_for.h>
 #include <iostream>
 
 
@@ -47,12 +49,12 @@ namespace directional
         Eigen::VectorXd nonPlanarityMeasure;
         Eigen::SparseMatrix<std::complex<double> > planarityWeight;
 
-        //conjugacy matrix
-        std::vector<Eigen::Matrix<double, 4,4> > H;
+        //conjugacy matrix (fixed-size per-face blocks, stored contiguously and aligned for vectorization)
+        std::vector<Eigen::Matrix<double, 4,4>, Eigen::aligned_allocator<Eigen::Matrix<double, 4,4> > > H;
 
         //conjugacy matrix eigenvectors and (scaled) eigenvalues
-        std::vector<Eigen::Matrix<double, 4,4> > UH;
-        std::vector<Eigen::Matrix<double, 4,1> > s;
+        std::vector<Eigen::Matrix<double, 4,4>, Eigen::aligned_allocator<Eigen::Matrix<double, 4,4> > > UH;
+        std::vector<Eigen::Matrix<double, 4,1>, Eigen::aligned_allocator<Eigen::Matrix<double, 4,1> > > s;
 
         //laplacians
         Eigen::SparseMatrix<std::complex<double>> DDA, DDB;
@@ -179,7 +181,8 @@ IGL_INLINE void directional::ConjugateFFSolverData::precomputeConjugacyStuff()
     UH.resize(numF);
     s.resize(numF);
 
-    for (int i = 0; i<numF; ++i)
+    //every face is independent
+    igl::parallel_for(numF, [&](const int i)
     {
         //compute conjugacy matrix
         double e1x = dmin(i,0), e1y = dmin(i,1), e2x = dmax(i,0), e2y = dmax(i,1), k1 = kmin[i], k2 = kmax[i];
@@ -199,7 +202,7 @@ IGL_INLINE void directional::ConjugateFFSolverData::precomputeConjugacyStuff()
         UH[i] = es.eigenvectors().real();
 
 
-    }
+    }, 1000);
 }
 
 
@@ -370,11 +373,11 @@ IGL_INLINE void directional::ConjugateFFSolverData::evaluateConjugacy(const dire
     Eigen::MatrixXd pvU(Us.rows(),2); pvU << igl::dot_row(Us,B1), igl::dot_row(Us,B2);
     Eigen::MatrixXd pvV(Us.rows(),2);  pvV << igl::dot_row(Vs,B1), igl::dot_row(Vs,B2);
     conjValues.resize(numF,1);
-    for (int j =0; j<numF; ++j)
+    igl::parallel_for(numF, [&](const int j)
     {
         Eigen::Matrix<double, 4, 1> x; x<<pvU.row(j).transpose(), pvV.row(j).transpose();
         conjValues[j] = x.transpose()*H[j]*x;
-    }
+    }, 1000);
 }
 
 IGL_INLINE void directional::ConjugateFFSolverData::evaluateConjugacy(const Eigen::Matrix<double, Eigen::Dynamic, 2> pvU,
@@ -382,11 +385,11 @@ IGL_INLINE void directional::ConjugateFFSolverData::evaluateConjugacy(const Eige
                                                                       Eigen::Matrix<double, Eigen::Dynamic, 1> &conjValues) const
 {
     conjValues.resize(numF,1);
-    for (int j =0; j<numF; ++j)
+    igl::parallel_for(numF, [&](const int j)
     {
         Eigen::Matrix<double, 4, 1> x; x<<pvU.row(j).transpose(), pvV.row(j).transpose();
         conjValues[j] = x.transpose()*H[j]*x;
-    }
+    }, 1000);
 }
 
 #endif
@@ -9,10 +9,13 @@
 #define DIRECTIONAL_INTRINSIC_FACE_TANGENT_BUNDLE_H
 
 #include <iostream>
+#include <limits>
+#include <algorithm>
 #include <Eigen/Geometry>
 #include <Eigen/Sparse>
 #include <igl/boundary_loop.h>
 #include <igl/doublearea.h>
+#include <igl/parallel_for.h>
 #include <directional/dual_cycles.h>
 #include <directional/TriMesh.h>
 #include <directional/TangentBundle.h>
@@ -21,51 +24,79 @@
 /***
 This class represents piecewise-constant face-based tangent bundles, where tangent spaces identify with the natural plane to every triangle of a 2-manifold mesh, connections are across
  (dual) edges, and local cycles are around vertices, with curvature being discrete angle defect.
+ IntrinsicFaceTangentBundle is the double-precision bundle.
  ***/
 
 namespace directional{
 
-    class IntrinsicFaceTangentBundle : public TangentBundle{
+    template<typename Scalar>
+    class IntrinsicFaceTangentBundleT : public TangentBundleT<Scalar>{
     public:
 
-        const TriMesh* mesh;
+        typedef typename TangentBundleT<Scalar>::MatrixXs MatrixXs;
+        typedef typename TangentBundleT<Scalar>::VectorXs VectorXs;
+        typedef Eigen::Matrix<Scalar, 1, 3> RowVector3s;
+        typedef Eigen::Matrix<Scalar, 1, 2> RowVector2s;
+
+        using TangentBundleT<Scalar>::intDimension;
+        using TangentBundleT<Scalar>::adjSpaces;
+        using TangentBundleT<Scalar>::oneRing;
+        using TangentBundleT<Scalar>::oneRingOffsets;
+        using TangentBundleT<Scalar>::oneRingAdjacencies;
+        using TangentBundleT<Scalar>::innerAdjacencies;
+        using TangentBundleT<Scalar>::cycles;
+        using TangentBundleT<Scalar>::cycleCurvatures;
+        using TangentBundleT<Scalar>::local2Cycle;
+        using TangentBundleT<Scalar>::connection;
+        using TangentBundleT<Scalar>::connectionMass;
+        using TangentBundleT<Scalar>::tangentSpaceMass;
+        using TangentBundleT<Scalar>::sources;
+        using TangentBundleT<Scalar>::normals;
+        using TangentBundleT<Scalar>::cycleSources;
+        using TangentBundleT<Scalar>::cycleNormals;
+
+        const TriMeshT<Scalar>* mesh;
 
         discTangTypeEnum discTangType() const {return discTangTypeEnum::FACE_SPACES;}
 
         bool hasCochainSequence() const { return true; }
         bool hasEmbedding() const { return true; }
 
-        IntrinsicFaceTangentBundle(){}
-        ~IntrinsicFaceTangentBundle(){}
+        IntrinsicFaceTangentBundleT(){}
+        ~IntrinsicFaceTangentBundleT(){}
 
-        void IGL_INLINE init(const TriMesh& _mesh){
+        void IGL_INLINE init(const TriMeshT<Scalar>& _mesh){
 
             intDimension = 2;
-            typedef std::complex<double> Complex;
             mesh = &_mesh;
 
             //adjacency relation is by dual edges.
             adjSpaces = mesh->EF;
             oneRing = mesh->FE;
+            oneRingOffsets = Eigen::VectorXi::LinSpaced(mesh->F.rows()+1, 0, 3*mesh->F.rows());
+            oneRingAdjacencies.resize(3*mesh->F.rows());
+            for (int i=0;i<mesh->F.rows();i++)
+                oneRingAdjacencies.segment(3*i,3)=mesh->FE.row(i).transpose();
+
+            //TODO: cycles, cycleCurvature
+            directional::dual_cycles(mesh->V, mesh->F, mesh->EV, mesh->EF, cycles, cycleCurvatures, local2Cycle, innerAdjacencies);
+            this->update_cycle_to_local();
+
+            update_geometry();
+        }
+
+        //Recomputes the geometric quantities (embedding, connection, cycle curvatures and masses) from the current geometry of the mesh, reusing the combinatorics and the cycles.
+        //Call after TriMesh::update_geometry() on the underlying mesh.
+        void IGL_INLINE update_geometry(){
+
+            typedef std::complex<Scalar> Complex;
+
             sources = mesh->barycenters;
             normals = mesh->faceNormals;
             cycleSources = mesh->V;
             cycleNormals = mesh->vertexNormals;
 
-            //connection is the ratio of the complex representation of edges
-            connection.resize(mesh->EF.rows(),1);  //the difference in the angle representation of edge i from EF(i,0) to EF(i,1)
-            Eigen::MatrixXd edgeVectors(mesh->EF.rows(), 3);
-            for (int i = 0; i < mesh->EF.rows(); i++) {
-                if (mesh->EF(i, 0) == -1 || mesh->EF(i, 1) == -1)
-                    continue;
-                edgeVectors.row(i) = (mesh->V.row(mesh->EV(i, 1)) - mesh->V.row(mesh->EV(i, 0))).normalized();
-                Complex ef(edgeVectors.row(i).dot(mesh->FBx.row(mesh->EF(i, 0))), edgeVectors.row(i).dot(mesh->FBy.row(mesh->EF(i, 0))));
-                Complex eg(edgeVectors.row(i).dot(mesh->FBx.row(mesh->EF(i, 1))), edgeVectors.row(i).dot(mesh->FBy.row(mesh->EF(i, 1))));
-                connection(i) = eg / ef;
-            }
-
-            //TODO: cycles, cycleCurvature
-            directional::dual_cycles(mesh->V, mesh->F, mesh->EV, mesh->EF, cycles, cycleCurvatures, local2Cycle, innerAdjacencies);
+            directional::dual_cycle_curvatures(mesh->V, mesh->F, mesh->EV, mesh->EF, cycles, local2Cycle, innerAdjacencies, cycleCurvatures);
 
             //drawing from mesh geometry
 
@@ -73,26 +104,59 @@ namespace directional{
 
             //mass are face areas
             igl::doublearea(mesh->V,mesh->F,tangentSpaceMass);
-            tangentSpaceMass.array()/=2.0;
-
-            //The "harmonic" weights from [Brandt et al. 2020].
-            connectionMass.resize(mesh->EF.rows());
-            for (int i=0;i<mesh->EF.rows();i++){
-                if ((mesh->EF(i,0)==-1)||(mesh->EF(i,1)==-1))
-                    continue;  //boundary edge
+            tangentSpaceMass.array()/=Scalar(2);
+
+            //connection is the ratio of the complex representation of edges, and the connection masses are the "harmonic" weights from [Brandt et al. 2020].
+            //Both are computed on blocks of inner edges: the edge vectors and face bases of each block are gathered into structure-of-arrays form (one column per coordinate),
+            //so that all arithmetic is on contiguous columns, and the blocks are processed in parallel when the mesh is constructed in parallel.
+            typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> ArrayXs;
+            typedef Eigen::Array<Scalar, Eigen::Dynamic, 3> ArrayX3s;
+            const int blockSize = 256;
+            const int numBlocks = (mesh->innerEdges.size()+blockSize-1)/blockSize;
+            const size_t minParallel = (mesh->parallelConstruction ? 4 : std::numeric_limits<size_t>::max());
+            connection.resize(mesh->EF.rows(),1);  //the difference in the angle representation of edge i from EF(i,0) to EF(i,1)
+            connectionMass=VectorXs::Zero(mesh->EF.rows());
+            igl::parallel_for(numBlocks, [&](const int b){
+                const int start = b*blockSize;
+                const int size = std::min(blockSize, (int)mesh->innerEdges.size()-start);
+                ArrayX3s edgeVectors(size,3), FBx0(size,3), FBy0(size,3), FBx1(size,3), FBy1(size,3);
+                ArrayXs mass0(size);
+                for (int k=0;k<size;k++){
+                    const int i = mesh->innerEdges(start+k);
+                    edgeVectors.row(k) = mesh->V.row(mesh->EV(i, 1)) - mesh->V.row(mesh->EV(i, 0));
+                    FBx0.row(k) = mesh->FBx.row(mesh->EF(i, 0));
+                    FBy0.row(k) = mesh->FBy.row(mesh->EF(i, 0));
+                    FBx1.row(k) = mesh->FBx.row(mesh->EF(i, 1));
+                    FBy1.row(k) = mesh->FBy.row(mesh->EF(i, 1));
+                    mass0(k) = tangentSpaceMass(mesh->EF(i, 0));
+                }
 
-                double primalLengthSquared = (mesh->V.row(mesh->EV(i,0))-mesh->V.row(mesh->EV(i,1))).squaredNorm();
-                connectionMass(i)=3*primalLengthSquared/(tangentSpaceMass(mesh->EF(i,0))+tangentSpaceMass(mesh->EF(i,0)));
-            }
+                ArrayXs primalLengthSquared = edgeVectors.col(0).square() + edgeVectors.col(1).square() + edgeVectors.col(2).square();
+                ArrayXs primalLength = primalLengthSquared.sqrt();
+                for (int j=0;j<3;j++)
+                    edgeVectors.col(j) /= primalLength;
+
+                ArrayXs efx = edgeVectors.col(0)*FBx0.col(0) + edgeVectors.col(1)*FBx0.col(1) + edgeVectors.col(2)*FBx0.col(2);
+                ArrayXs efy = edgeVectors.col(0)*FBy0.col(0) + edgeVectors.col(1)*FBy0.col(1) + edgeVectors.col(2)*FBy0.col(2);
+                ArrayXs egx = edgeVectors.col(0)*FBx1.col(0) + edgeVectors.col(1)*FBx1.col(1) + edgeVectors.col(2)*FBx1.col(2);
+                ArrayXs egy = edgeVectors.col(0)*FBy1.col(0) + edgeVectors.col(1)*FBy1.col(1) + edgeVectors.col(2)*FBy1.col(2);
+                ArrayXs mass = 3*primalLengthSquared/(mass0+mass0);
+
+                for (int k=0;k<size;k++){
+                    const int i = mesh->innerEdges(start+k);
+                    connection(i) = Complex(egx(k), egy(k)) / Complex(efx(k), efy(k));
+                    connectionMass(i) = mass(k);
+                }
+            }, minParallel);
         }
 
 
         //projecting an arbitrary set of extrinsic vectors (e.g. coming from user-prescribed constraints) into intrinsic vectors.
-        Eigen::MatrixXd  virtual IGL_INLINE project_to_intrinsic(const Eigen::VectorXi& tangentSpaces, const Eigen::MatrixXd& extDirectionals) const{
+        MatrixXs  virtual IGL_INLINE project_to_intrinsic(const Eigen::VectorXi& tangentSpaces, const MatrixXs& extDirectionals) const{
             assert(tangentSpaces.rows()==extDirectionals.rows());
 
             int N = extDirectionals.cols()/3;
-            Eigen::MatrixXd intDirectionals(tangentSpaces.rows(),2*N);
+            MatrixXs intDirectionals(tangentSpaces.rows(),2*N);
 
             for (int i=0;i<tangentSpaces.rows();i++)
                 for (int j=0;j<N;j++)
@@ -103,7 +167,7 @@ namespace directional{
 
 
         //projecting intrinsic to extrinsic
-        Eigen::MatrixXd virtual IGL_INLINE project_to_extrinsic(const Eigen::VectorXi& tangentSpaces, const Eigen::MatrixXd& intDirectionals) const {
+        MatrixXs virtual IGL_INLINE project_to_extrinsic(const Eigen::VectorXi& tangentSpaces, const MatrixXs& intDirectionals) const {
 
             assert(tangentSpaces.rows()==intDirectionals.rows() || tangentSpaces.rows()==0);
             Eigen::VectorXi actualTangentSpaces;
@@ -113,7 +177,7 @@ namespace directional{
                 actualTangentSpaces = tangentSpaces;
 
             int N = intDirectionals.cols()/2;
-            Eigen::MatrixXd extDirectionals(actualTangentSpaces.rows(),3);
+            MatrixXs extDirectionals(actualTangentSpaces.rows(),3);
 
             extDirectionals.conservativeResize(intDirectionals.rows(),intDirectionals.cols()*3/2);
             for (int i=0;i<intDirectionals.rows();i++)
@@ -124,19 +188,19 @@ namespace directional{
         }
 
         void IGL_INLINE interpolate(const Eigen::MatrixXi &elemIndices,
-                                    const Eigen::MatrixXd &baryCoords,
-                                    const Eigen::MatrixXd &intDirectionals,
-                                    Eigen::MatrixXd& interpSources,
-                                    Eigen::MatrixXd& interpNormals,
-                                    Eigen::MatrixXd& interpField) const {
+                                    const MatrixXs &baryCoords,
+                                    const MatrixXs &intDirectionals,
+                                    MatrixXs& interpSources,
+                                    MatrixXs& interpNormals,
+                                    MatrixXs& interpField) const {
 
             assert(elemIndices.rows()==baryCoords.rows());
             assert(baryCoords.rows()==intDirectionals.rows());
 
             int N = intDirectionals.cols()/2;
-            interpSources=Eigen::MatrixXd::Zero(elemIndices.rows(),3);
-            interpNormals=Eigen::MatrixXd::Zero(elemIndices.rows(),3);
-            interpField=Eigen::MatrixXd::Zero(elemIndices.rows(),3*N);
+            interpSources=MatrixXs::Zero(elemIndices.rows(),3);
+            interpNormals=MatrixXs::Zero(elemIndices.rows(),3);
+            interpField=MatrixXs::Zero(elemIndices.rows(),3*N);
 
             //in face based fields the only thing that matters is the identity of the face
             for (int i=0;i<elemIndices.rows();i++){
@@ -149,17 +213,17 @@ namespace directional{
 
         }
 
-        Eigen::SparseMatrix<double> IGL_INLINE gradient_operator(const int N,
+        Eigen::SparseMatrix<Scalar> IGL_INLINE gradient_operator(const int N,
                                                                  const boundCondTypeEnum boundCondType){
             assert(hasCochainSequence()==true);
-            Eigen::SparseMatrix<double> singleGradMatrix(2*mesh->F.size(), mesh->V.size());
-            std::vector<Eigen::Triplet<double>> singleGradMatTriplets;
+            Eigen::SparseMatrix<Scalar> singleGradMatrix(2*mesh->F.size(), mesh->V.size());
+            std::vector<Eigen::Triplet<Scalar>> singleGradMatTriplets;
             for (int i=0;i<mesh->F.rows();i++)
                 for (int j=0;j<3;j++){
-                    Eigen::RowVector3d e = mesh->V.row(mesh->F(i,(j+2)%3))-mesh->V.row(mesh->F(i,(j+1)%3));
-                    Eigen::RowVector2d eperp; eperp<<e.dot(-mesh->FBy.row(i)),e.dot(mesh->FBx.row(i));
-                    singleGradMatTriplets.push_back(Eigen::Triplet<double>(2*i,j,eperp(0)));
-                    singleGradMatTriplets.push_back(Eigen::Triplet<double>(2*i+1,j,eperp(1)));
+                    RowVector3s e = mesh->V.row(mesh->F(i,(j+2)%3))-mesh->V.row(mesh->F(i,(j+1)%3));
+                    RowVector2s eperp; eperp<<e.dot(-mesh->FBy.row(i)),e.dot(mesh->FBx.row(i));
+                    singleGradMatTriplets.push_back(Eigen::Triplet<Scalar>(2*i,j,eperp(0)));
+                    singleGradMatTriplets.push_back(Eigen::Triplet<Scalar>(2*i+1,j,eperp(1)));
                 }
 
             singleGradMatrix.setFromTriplets(singleGradMatTriplets.begin(), singleGradMatTriplets.end());
@@ -168,37 +232,37 @@ namespace directional{
                 return singleGradMatrix;
 
             //else, kroning matrix.
-            Eigen::SparseMatrix<double> gradMatrixN(2*N*mesh->F.rows(), N*mesh->V.rows());
-            std::vector<Eigen::Triplet<double>> gradMatrixNTris;
+            Eigen::SparseMatrix<Scalar> gradMatrixN(2*N*mesh->F.rows(), N*mesh->V.rows());
+            std::vector<Eigen::Triplet<Scalar>> gradMatrixNTris;
             for (int i=0;i<singleGradMatTriplets.size();i++)
                 for (int j=0;j<N;j++)
-                    gradMatrixNTris.push_back(Eigen::Triplet<double>(N*(singleGradMatTriplets[i].row()-singleGradMatTriplets[i].row()%2)+2*j+singleGradMatTriplets[i].row()%2, singleGradMatTriplets[i].col()*N+j, singleGradMatTriplets[i].value()));
+                    gradMatrixNTris.push_back(Eigen::Triplet<Scalar>(N*(singleGradMatTriplets[i].row()-singleGradMatTriplets[i].row()%2)+2*j+singleGradMatTriplets[i].row()%2, singleGradMatTriplets[i].col()*N+j, singleGradMatTriplets[i].value()));
 
             return gradMatrixN;
             //TODO: boundaries
         }
 
         //TODO: boundaries
-        Eigen::SparseMatrix<double> IGL_INLINE curl_operator(const int N,
+        Eigen::SparseMatrix<Scalar> IGL_INLINE curl_operator(const int N,
                                                              const boundCondTypeEnum boundCondType,
                                                              const Eigen::VectorXi& matching){
             assert(hasCochainSequence()==true);
 
-            Eigen::SparseMatrix<double> singleCurlMatrix(mesh->innerEdges.size(), 2*mesh->F.rows());
-            std::vector<Eigen::Triplet<double>> singleCurlMatTris;
+            Eigen::SparseMatrix<Scalar> singleCurlMatrix(mesh->innerEdges.size(), 2*mesh->F.rows());
+            std::vector<Eigen::Triplet<Scalar>> singleCurlMatTris;
             for (int i=0;i<mesh->innerEdges.size();i++){
-                Eigen::RowVector3d e = mesh->V.row(mesh->EV(mesh->innerEdges(i),1))-mesh->V.row(mesh->EV(mesh->innerEdges(i),0));
+                RowVector3s e = mesh->V.row(mesh->EV(mesh->innerEdges(i),1))-mesh->V.row(mesh->EV(mesh->innerEdges(i),0));
                 //curl is <right_face - left_face , e>
-                Eigen::RowVector2d einLeft; einLeft<<e.dot(mesh->FBx.row(mesh->EF(mesh->innerEdges(i),0))),
+                RowVector2s einLeft; einLeft<<e.dot(mesh->FBx.row(mesh->EF(mesh->innerEdges(i),0))),
                         e.dot(mesh->FBy.row(mesh->EF(mesh->innerEdges(i),0)));
 
-                Eigen::RowVector2d einRight; einRight<<e.dot(mesh->FBx.row(mesh->EF(mesh->innerEdges(i),1))),
+                RowVector2s einRight; einRight<<e.dot(mesh->FBx.row(mesh->EF(mesh->innerEdges(i),1))),
                         e.dot(mesh->FBy.row(mesh->EF(mesh->innerEdges(i),1)));
 
-                singleCurlMatTris.push_back(Eigen::Triplet<double>(i, 2*mesh->EF(mesh->innerEdges(i),0),-einLeft(0)));
-                singleCurlMatTris.push_back(Eigen::Triplet<double>(i, 2*mesh->EF(mesh->innerEdges(i),0)+1,-einLeft(1)));
-                singleCurlMatTris.push_back(Eigen::Triplet<double>(i, 2*mesh->EF(mesh->innerEdges(i),1),einRight(0)));
-                singleCurlMatTris.push_back(Eigen::Triplet<double>(i, 2*mesh->EF(mesh->innerEdges(i),1)+1,einRight(1)));
+                singleCurlMatTris.push_back(Eigen::Triplet<Scalar>(i, 2*mesh->EF(mesh->innerEdges(i),0),-einLeft(0)));
+                singleCurlMatTris.push_back(Eigen::Triplet<Scalar>(i, 2*mesh->EF(mesh->innerEdges(i),0)+1,-einLeft(1)));
+                singleCurlMatTris.push_back(Eigen::Triplet<Scalar>(i, 2*mesh->EF(mesh->innerEdges(i),1),einRight(0)));
+                singleCurlMatTris.push_back(Eigen::Triplet<Scalar>(i, 2*mesh->EF(mesh->innerEdges(i),1)+1,einRight(1)));
             }
 
             singleCurlMatrix.setFromTriplets(singleCurlMatTris.begin(), singleCurlMatTris.end());
@@ -206,28 +270,28 @@ namespace directional{
             if (N==1)
                 return singleCurlMatrix;
 
-            Eigen::SparseMatrix<double> curlMatrixN(N*mesh->innerEdges.size(), 2*N*mesh->F.rows());
-            std::vector<Eigen::Triplet<double>> curlMatNTris;
+            Eigen::SparseMatrix<Scalar> curlMatrixN(N*mesh->innerEdges.size(), 2*N*mesh->F.rows());
+            std::vector<Eigen::Triplet<Scalar>> curlMatNTris;
 
             for (int i=0;i<mesh->innerEdges.size();i++){
-                Eigen::RowVector3d e = mesh->V.row(mesh->EV(mesh->innerEdges(i),1))-mesh->V.row(mesh->EV(mesh->innerEdges(i),0));
+                RowVector3s e = mesh->V.row(mesh->EV(mesh->innerEdges(i),1))-mesh->V.row(mesh->EV(mesh->innerEdges(i),0));
                 //curl is <right_face - left_face , e>
-                Eigen::RowVector2d einLeft; einLeft<<e.dot(mesh->FBx.row(mesh->EF(mesh->innerEdges(i),0))),
+                RowVector2s einLeft; einLeft<<e.dot(mesh->FBx.row(mesh->EF(mesh->innerEdges(i),0))),
                         e.dot(mesh->FBy.row(mesh->EF(mesh->innerEdges(i),0)));
 
-                Eigen::RowVector2d einRight; einRight<<e.dot(mesh->FBx.row(mesh->EF(mesh->innerEdges(i),1))),
+                RowVector2s einRight; einRight<<e.dot(mesh->FBx.row(mesh->EF(mesh->innerEdges(i),1))),
                         e.dot(mesh->FBy.row(mesh->EF(mesh->innerEdges(i),1)));
 
                 for (int j=0;j<N;j++) {
                     int matchj = (j+matching(mesh->innerEdges(i))+100*N)%N;
                     curlMatNTris.push_back(
-                            Eigen::Triplet<double>(N*i+j, 2*N*i+2*j*mesh->EF(mesh->innerEdges(i), 0), -einLeft(0)));
+                            Eigen::Triplet<Scalar>(N*i+j, 2*N*i+2*j*mesh->EF(mesh->innerEdges(i), 0), -einLeft(0)));
                     curlMatNTris.push_back(
-                            Eigen::Triplet<double>(N*i+j, 2*N*i+2*j*mesh->EF(mesh->innerEdges(i), 0) + 1, -einLeft(1)));
+                            Eigen::Triplet<Scalar>(N*i+j, 2*N*i+2*j*mesh->EF(mesh->innerEdges(i), 0) + 1, -einLeft(1)));
                     curlMatNTris.push_back(
-                            Eigen::Triplet<double>(N*i+j, 2*N*i+2*matchj*mesh->EF(mesh->innerEdges(i), 1), einRight(0)));
+                            Eigen::Triplet<Scalar>(N*i+j, 2*N*i+2*matchj*mesh->EF(mesh->innerEdges(i), 1), einRight(0)));
                     curlMatNTris.push_back(
-                            Eigen::Triplet<double>(N*i+j, 2*N*i+2*matchj* mesh->EF(mesh->innerEdges(i), 1) + 1, einRight(1)));
+                            Eigen::Triplet<Scalar>(N*i+j, 2*N*i+2*matchj* mesh->EF(mesh->innerEdges(i), 1) + 1, einRight(1)));
                 }
             }
             curlMatrixN.setFromTriplets(curlMatNTris.begin(), curlMatNTris.end());
@@ -236,6 +300,8 @@ namespace directional{
 
     };
 
+    typedef IntrinsicFaceTangentBundleT<double> IntrinsicFaceTangentBundle;
+
 }
 
 
@@ -31,7 +31,8 @@ namespace directional{
     public:
 
         const TriMesh* mesh;
-        Eigen::MatrixXd tangentStartAngles;  //where each edge begins on the intrinsic space
+        Eigen::VectorXd oneRingTangentStartAngles;  //where each edge begins on the intrinsic space, in the compressed one-ring layout of the mesh (vertexOneRingOffsets)
+        Eigen::MatrixXd tangentStartAngles;  //Dense #V x max(valence) version of the above, ordered as the mesh VE (unused entries are 0); only computed when the mesh has denseOneRings set.
 
         virtual discTangTypeEnum discTangType() const {return discTangTypeEnum::VERTEX_SPACES;}
         virtual bool hasCochainSequence() const { return false; }
@@ -43,68 +44,93 @@ namespace directional{
         void IGL_INLINE init(const TriMesh& _mesh){
 
             intDimension = 2;
-            typedef std::complex<double> Complex;
             mesh = &_mesh;
 
             //adjacency relation is by dual edges.
             adjSpaces = mesh->EV;
-            oneRing = mesh->VE;
-            Eigen::VectorXi valence = mesh->vertexValence;
+            oneRingOffsets = mesh->vertexOneRingOffsets;
+            oneRingAdjacencies = mesh->vertexOneRingEdges;
+            if (mesh->denseOneRings)
+                compute_dense_one_rings();
+            else
+                oneRing.resize(0,0);
+
+            local2Cycle.resize(mesh->F.rows());
+            cycles.resize(mesh->F.rows(), mesh->EV.rows());  //TODO: higher genus and boundaries
+            innerAdjacencies.resize(mesh->EV.rows());
+            std::vector<Eigen::Triplet<double>> cyclesTriplets;
+            for (int i=0;i<mesh->F.rows();i++){
+                local2Cycle(i)=i;
+                for (int j=0;j<3;j++)
+                    cyclesTriplets.push_back(Eigen::Triplet<double>(i,mesh->FE(i,j),mesh->FEs(i,j)));
+            }
+            cycles.setFromTriplets(cyclesTriplets.begin(), cyclesTriplets.end());
+
+            for (int i=0;i<mesh->EV.rows();i++) //TODO: boundaries
+                innerAdjacencies(i)=i;
+            update_cycle_to_local();
+            //directional::dual_cycles(mesh->V, mesh->F, mesh->EV, mesh->EF, dualCycles, cycleCurvatures, element2Cycle, innerAdjacencies);
+
+            update_geometry();
+        }
+
+        //Recomputes the geometric quantities (embedding, tangent angles, connection, cycle curvatures and masses) from the current geometry of the mesh, reusing the combinatorics and the cycles.
+        //Call after TriMesh::update_geometry() on the underlying mesh.
+        void IGL_INLINE update_geometry(){
+
+            typedef std::complex<double> Complex;
+
             sources = mesh->V;
             normals = mesh->vertexNormals;
             cycleSources = mesh->barycenters;
             cycleNormals = mesh->faceNormals;
 
             //creating vertex tangent lookup table
-            tangentStartAngles.resize(mesh->V.rows(), mesh->vertexValence.maxCoeff());
+            oneRingTangentStartAngles.resize(mesh->vertexOneRingEdges.size());
             for (int i=0;i<mesh->V.rows();i++){
                 double totalTangentSum = (mesh->isBoundaryVertex(i) ? igl::PI : 2.0*igl::PI);
                 double angleSum =  totalTangentSum - mesh->GaussianCurvature(i);
-                tangentStartAngles.col(0).setZero();  //the first angle
+                int ringStart = mesh->vertexOneRingOffsets(i);
+                oneRingTangentStartAngles(ringStart)=0.0;  //the first angle
                 Eigen::RowVector3d prevEdgeVector = mesh->V.row(mesh->HV(mesh->nextH(mesh->VH(i))))-mesh->V.row(i);
                 int hebegin = mesh->VH(i);  //this should be the first boundary edge in case of boundary
                 int heiterate = mesh->twinH(mesh->prevH(hebegin));
-                int j=1;
+                int j=ringStart+1;
                 do{
                     Eigen::RowVector3d currEdgeVector = mesh->V.row(mesh->HV(mesh->nextH(heiterate)))-mesh->V.row(i);
                     double angleDiff = std::acos(currEdgeVector.dot(prevEdgeVector)/(prevEdgeVector.norm()*currEdgeVector.norm()));
-                    tangentStartAngles(i,j)=tangentStartAngles(i,j-1)+totalTangentSum*angleDiff/angleSum;
+                    oneRingTangentStartAngles(j)=oneRingTangentStartAngles(j-1)+totalTangentSum*angleDiff/angleSum;
                     heiterate = mesh->twinH(mesh->prevH(heiterate));
                     j++;
                     prevEdgeVector=currEdgeVector;
                 }while ((heiterate!=hebegin)&&(heiterate!=-1));
             }
+            if (mesh->denseOneRings)
+                compute_dense_tangent_start_angles();
 
             //connection is the ratio of the complex representation of mutual edges
             connection.resize(mesh->EV.rows(),1);  //the difference in the angle representation of edge i from EV(i,0) to EV(i,1)
-            Eigen::MatrixXd edgeVectors(mesh->EV.rows(), 3);
             for (int i = 0; i < mesh->EV.rows(); i++) {
-                //edgeVectors.row(i) = (mesh->V.row(mesh->EV(i, 1)) - mesh->V.row(mesh->EV(i, 0))).normalized();
                 //looking up edge in each tangent space
                 Complex ef,eg;
-                for (int j=0;j<mesh->vertexValence(mesh->EV(i,0));j++){
-                    if (mesh->VE(mesh->EV(i,0),j)==i)
-                        ef = exp(Complex(0,tangentStartAngles(mesh->EV(i, 0),j)));
+                for (int j=mesh->vertexOneRingOffsets(mesh->EV(i,0));j<mesh->vertexOneRingOffsets(mesh->EV(i,0)+1);j++){
+                    if (mesh->vertexOneRingEdges(j)==i)
+                        ef = exp(Complex(0,oneRingTangentStartAngles(j)));
                 }
 
-                for (int j=0;j<mesh->vertexValence(mesh->EV(i,1));j++) {
-                  if (mesh->VE(mesh->EV(i, 1), j) == i)
-                      eg = exp(Complex(0, tangentStartAngles(mesh->EV(i, 1), j)));
+                for (int j=mesh->vertexOneRingOffsets(mesh->EV(i,1));j<mesh->vertexOneRingOffsets(mesh->EV(i,1)+1);j++) {
+                  if (mesh->vertexOneRingEdges(j) == i)
+                      eg = exp(Complex(0, oneRingTangentStartAngles(j)));
               }
 
               connection(i) = -eg / ef;
             }
 
-            local2Cycle.resize(mesh->F.rows());
+            //the curvature of each triangle cycle is the holonomy of the connection around it
             cycleCurvatures=Eigen::VectorXd::Zero(mesh->F.rows());
-            cycles.resize(mesh->F.rows(), mesh->EV.rows());  //TODO: higher genus and boundaries
-            innerAdjacencies.resize(mesh->EV.rows());
-            std::vector<Eigen::Triplet<double>> cyclesTriplets;
             for (int i=0;i<mesh->F.rows();i++){
-                local2Cycle(i)=i;
                 std::complex<double> complexHolonomy(1.0,0.0);
                 for (int j=0;j<3;j++){
-                    cyclesTriplets.push_back(Eigen::Triplet<double>(i,mesh->FE(i,j),mesh->FEs(i,j)));
                     if (mesh->FEs(i,j)>0)
                         complexHolonomy*=connection(mesh->FE(i,j));
                     else
@@ -112,16 +138,11 @@ namespace directional{
                 }
                 cycleCurvatures(i)=arg(complexHolonomy);
             }
-            cycles.setFromTriplets(cyclesTriplets.begin(), cyclesTriplets.end());
-
-            for (int i=0;i<mesh->EV.rows();i++) //TODO: boundaries
-                innerAdjacencies(i)=i;
-            //directional::dual_cycles(mesh->V, mesh->F, mesh->EV, mesh->EF, dualCycles, cycleCurvatures, element2Cycle, innerAdjacencies);
 
             //drawing from mesh geometry
 
             /************masses****************/
-            connectionMass.resize(mesh->EV.rows());
+            connectionMass=Eigen::VectorXd::Zero(mesh->EV.rows());
             tangentSpaceMass.resize(mesh->V.rows());
 
             //cotangent weights
@@ -149,6 +170,21 @@ namespace directional{
 
         }
 
+        //Fills the padded oneRing from the compressed one-rings. Unused entries are -1.
+        void IGL_INLINE compute_dense_one_rings(){
+            oneRing = Eigen::MatrixXi::Constant(mesh->V.rows(), mesh->vertexValence.maxCoeff(), -1);
+            for (int i=0;i<mesh->V.rows();i++)
+                for (int j=oneRingOffsets(i);j<oneRingOffsets(i+1);j++)
+                    oneRing(i,j-oneRingOffsets(i))=oneRingAdjacencies(j);
+        }
+
+        //Fills the dense tangentStartAngles from the compressed ones.
+        void IGL_INLINE compute_dense_tangent_start_angles(){
+            tangentStartAngles=Eigen::MatrixXd::Zero(mesh->V.rows(), mesh->vertexValence.maxCoeff());
+            for (int i=0;i<mesh->V.rows();i++)
+                for (int j=mesh->vertexOneRingOffsets(i);j<mesh->vertexOneRingOffsets(i+1);j++)
+                    tangentStartAngles(i,j-mesh->vertexOneRingOffsets(i))=oneRingTangentStartAngles(j);
+        }
 
         //projecting an arbitrary set of extrinsic vectors (e.g. coming from user-prescribed constraints) into intrinsic vectors.
         Eigen::MatrixXd  virtual IGL_INLINE project_to_intrinsic(const Eigen::VectorXi& tangentSpaces, const Eigen::MatrixXd& extDirectionals) const{
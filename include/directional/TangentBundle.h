@@ -18,6 +18,7 @@
  Further structure is cycles around which holonomy is measured, and curvature is defined, and consequently one-rings of all edges around a single node.
  The Tangent Bundle is "intrinsic" in the sense that the information required for designing fields does not require any embedding. The class includes variables that include embedding information like sources and normals (assuming the bundle is at most 1-codimensional).
  They are however only used for input/output to the intrinsic variables.
+ The geometric quantities are of type Scalar; TangentBundle is the double-precision bundle.
 ***/
 
 namespace directional{
@@ -26,9 +27,14 @@ namespace directional{
     enum class discTangTypeEnum {BASE_CLASS, FACE_SPACES, VERTEX_SPACES};
     enum class boundCondTypeEnum {DIRICHLET, NEUMANN};
 
-    class TangentBundle {
+    template<typename Scalar>
+    class TangentBundleT {
     public:
 
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixXs;
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorXs;
+        typedef Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, 1> VectorXcs;
+
         //In case some methods are only defined for specific tangent bundles
         virtual discTangTypeEnum discTangType() const { return discTangTypeEnum::BASE_CLASS; }
 
@@ -42,66 +48,87 @@ namespace directional{
 
         //combinatorics and topology
         Eigen::Matrix<int, Eigen::Dynamic, 2> adjSpaces;    //Adjacent tangent spaces (edges of the tangent bundle graph)
-        Eigen::MatrixXi oneRing;                            //(Ordered) tangent spaces adjacent around each tangent space
+        Eigen::MatrixXi oneRing;                            //Optional compatibility view of the one-rings below, padded with -1 to the maximal one-ring size; for vertex bundles, only filled when the mesh has denseOneRings set
+        Eigen::VectorXi oneRingOffsets;                     //Compressed one-rings: the (ordered) adjacencies around tangent space i are oneRingAdjacencies in [oneRingOffsets(i), oneRingOffsets(i+1))
+        Eigen::VectorXi oneRingAdjacencies;                 //Indices into adjSpaces
         Eigen::VectorXi innerAdjacencies;                   //Indices into adjSpaces that are not boundary
         Eigen::SparseMatrix<double> cycles;                 //Adjaceny matrix of cycles
-        Eigen::VectorXd cycleCurvatures;                    //Curvature of cycles.
+        VectorXs cycleCurvatures;                           //Curvature of cycles.
         Eigen::VectorXi local2Cycle;                        //Map between local cycles and general cycles
+        Eigen::VectorXi cycle2LocalOffsets;                 //Inverse of local2Cycle, compressed: the local cycles of cycle i are cycle2Local in [cycle2LocalOffsets(i), cycle2LocalOffsets(i+1))
+        Eigen::VectorXi cycle2Local;                        //(built by update_cycle_to_local(); used for incremental index updates)
 
         //Geometry
         //the connection between adjacent tangent space. That is, a field is parallel between adjaspaces(i,0) and adjSpaces(i,1) when complex(intField.row(adjSpaceS(i,0))*connection(i))=complex(intField.row(adjSpaceS(i,1))
-        Eigen::VectorXcd connection;                        //#V, Metric connection between adjacent spaces
-        Eigen::VectorXd connectionMass;                     //The mass matrix of connections, of size #adjSpaces
-        Eigen::VectorXd tangentSpaceMass;                   //The inner-product mass for vectors in tangent spaces, of size #V (self masses) + #E (adjSpaces masses;  optional, usually for high-order fields)
+        VectorXcs connection;                               //#V, Metric connection between adjacent spaces
+        VectorXs connectionMass;                            //The mass matrix of connections, of size #adjSpaces
+        VectorXs tangentSpaceMass;                          //The inner-product mass for vectors in tangent spaces, of size #V (self masses) + #E (adjSpaces masses;  optional, usually for high-order fields)
 
         //Extrinsic components
-        Eigen::MatrixXd sources;  //the source point of the extrinsic vectors
-        Eigen::MatrixXd normals;  //the normals to the tangent spaces (assuming 1-codimension)
-        Eigen::MatrixXd cycleSources;  //source point of cycles
-        Eigen::MatrixXd cycleNormals;  //normals to cycles
-
-        TangentBundle() {}
-        ~TangentBundle() {}
+        MatrixXs sources;  //the source point of the extrinsic vectors
+        MatrixXs normals;  //the normals to the tangent spaces (assuming 1-codimension)
+        MatrixXs cycleSources;  //source point of cycles
+        MatrixXs cycleNormals;  //normals to cycles
+
+        TangentBundleT() {}
+        ~TangentBundleT() {}
+
+        //builds the compressed inverse of local2Cycle (cycle2LocalOffsets and cycle2Local). Called by the derived classes whenever the cycles are (re)computed.
+        void IGL_INLINE update_cycle_to_local(){
+            cycle2LocalOffsets = Eigen::VectorXi::Zero(cycles.rows()+1);
+            for (int i=0;i<local2Cycle.size();i++)
+                if ((local2Cycle(i)>=0)&&(local2Cycle(i)<cycles.rows()))
+                    cycle2LocalOffsets(local2Cycle(i)+1)++;
+            for (int i=0;i<cycles.rows();i++)
+                cycle2LocalOffsets(i+1)+=cycle2LocalOffsets(i);
+            cycle2Local.resize(cycle2LocalOffsets(cycles.rows()));
+            Eigen::VectorXi cycleCounter = cycle2LocalOffsets.head(cycles.rows());
+            for (int i=0;i<local2Cycle.size();i++)
+                if ((local2Cycle(i)>=0)&&(local2Cycle(i)<cycles.rows()))
+                    cycle2Local(cycleCounter(local2Cycle(i))++)=i;
+        }
 
         //projecting an arbitrary set of extrinsic vectors (e.g. coming from user-prescribed constraints) into intrinsic vectors.
-        Eigen::MatrixXd virtual IGL_INLINE project_to_intrinsic(const Eigen::VectorXi &tangentSpaces, const Eigen::MatrixXd &extDirectionals) const {
+        MatrixXs virtual IGL_INLINE project_to_intrinsic(const Eigen::VectorXi &tangentSpaces, const MatrixXs &extDirectionals) const {
             assert(false && "The base class does not have an embedding");
-            return Eigen::MatrixXd();
+            return MatrixXs();
         }
 
         //projecting extrinsic to intrinsic
-        Eigen::MatrixXd virtual IGL_INLINE project_to_extrinsic(const Eigen::VectorXi &tangentSpaces, const Eigen::MatrixXd &extDirectionals) const {
+        MatrixXs virtual IGL_INLINE project_to_extrinsic(const Eigen::VectorXi &tangentSpaces, const MatrixXs &extDirectionals) const {
             assert(false && "The base class does not have an embedding");
-            return Eigen::MatrixXd();
+            return MatrixXs();
         }
 
         //interpolating field from nodes in palces specified by barycentric coordinates. The interpolator needs to interpret them.
         void virtual IGL_INLINE interpolate(const Eigen::MatrixXi &elemIndices,
-                                            const Eigen::MatrixXd &baryCoords,
-                                            const Eigen::MatrixXd &intDirectionals,
-                                            Eigen::MatrixXd& interpSources,
-                                            Eigen::MatrixXd& interpNormals,
-                                            Eigen::MatrixXd& interpField)  const{
-            interpSources=Eigen::MatrixXd();
-            interpNormals=Eigen::MatrixXd();
-            interpField=Eigen::MatrixXd();
+                                            const MatrixXs &baryCoords,
+                                            const MatrixXs &intDirectionals,
+                                            MatrixXs& interpSources,
+                                            MatrixXs& interpNormals,
+                                            MatrixXs& interpField)  const{
+            interpSources=MatrixXs();
+            interpNormals=MatrixXs();
+            interpField=MatrixXs();
         }
 
-        Eigen::SparseMatrix<double> virtual IGL_INLINE gradient_operator(const int N,
+        Eigen::SparseMatrix<Scalar> virtual IGL_INLINE gradient_operator(const int N,
                                                                          const boundCondTypeEnum boundCondType){
             assert(hasCochainSequence()==true);
-            return Eigen::SparseMatrix<double>();  //actually unreachable since assert would fail.
+            return Eigen::SparseMatrix<Scalar>();  //actually unreachable since assert would fail.
         }
 
-        Eigen::SparseMatrix<double> virtual IGL_INLINE curl_operator(const int N,
+        Eigen::SparseMatrix<Scalar> virtual IGL_INLINE curl_operator(const int N,
                                                                      const boundCondTypeEnum boundCondType,
                                                                      const Eigen::VectorXi& matching=Eigen::VectorXi()){
             assert(hasCochainSequence()==true);
-            return Eigen::SparseMatrix<double>();  //actually unreachable since assert would fail.
+            return Eigen::SparseMatrix<Scalar>();  //actually unreachable since assert would fail.
         }
 
     };
 
+    typedef TangentBundleT<double> TangentBundle;
+
 }
 
 
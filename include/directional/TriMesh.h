@@ -9,6 +9,9 @@
 #define DIRECTIONAL_TRIMESH_H
 
 #include <iostream>
+#include <future>
+#include <functional>
+#include <limits>
 #include <Eigen/Geometry>
 #include <Eigen/Sparse>
 #include <igl/barycenter.h>
@@ -22,67 +25,167 @@
 #include <igl/avg_edge_length.h>
 #include <directional/gaussian_curvature.h>
 #include <igl/doublearea.h>
+#include <igl/parallel_for.h>
 #include <directional/dcel.h>
+#include <directional/polygonal_edge_topology.h>
+#include <directional/reorder_mesh.h>
 
 /***
  This class stores a general-purpose triangle mesh. The triangle mesh can be used to implement a tangent bundle in several ways
  (for instance, face- or vertex-based bundles).
+ The geometric quantities are of type Scalar (the combinatorial ones, including the edge signs FEs, do not depend on it); TriMesh is the double-precision mesh.
 ***/
 
 namespace directional{
 
-    class TriMesh{
+    template<typename Scalar>
+    class TriMeshT{
     public:
 
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixXs;
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorXs;
+        typedef Eigen::Matrix<Scalar, 1, 3> RowVector3s;
+
         //Basic quantities
-        Eigen::MatrixXd V;
+        MatrixXs V;
         Eigen::MatrixXi F;
 
         //combinatorial quantities
-        Eigen::MatrixXi EF, FE, EV,TT, EFi, VE, VF;
+        Eigen::MatrixXi EF, FE, EV,TT, EFi;
+        Eigen::MatrixXi VE, VF;   //Dense #V x max(valence) versions of the one-rings below; only computed when denseOneRings is set.
         Eigen::MatrixXd FEs;
         Eigen::VectorXi innerEdges, boundEdges, vertexValence;  //vertexValence is #(outgoing edges) (if boundary, then #faces+1 = vertexvalence)
         Eigen::VectorXi isBoundaryVertex, isBoundaryEdge;
 
+        //Compressed vertex one-rings: the edges (resp. faces) around vertex i in CCW order are vertexOneRingEdges (resp. vertexOneRingFaces) in [vertexOneRingOffsets(i), vertexOneRingOffsets(i+1)).
+        //The size of each one-ring is vertexValence(i). For boundary vertices, the ring starts with the boundary edge, and the last face entry is -1.
+        Eigen::VectorXi vertexOneRingOffsets, vertexOneRingEdges, vertexOneRingFaces;
+
         //DCEL quantities
         Eigen::VectorXi VH,HV,HE,HF,nextH,prevH,twinH;
         Eigen::MatrixXi EH,FH;
 
         //Geometric quantities
-        Eigen::MatrixXd faceNormals;
-        Eigen::MatrixXd faceAreas;
-        Eigen::MatrixXd vertexNormals;
-        Eigen::MatrixXd FBx,FBy;  //local basis vectors per face
-        Eigen::MatrixXd VBx,VBy;  //local basis vectors per vertex
-        Eigen::MatrixXd barycenters;
-        Eigen::VectorXd GaussianCurvature;
+        MatrixXs faceNormals;
+        MatrixXs faceAreas;
+        MatrixXs vertexNormals;
+        MatrixXs FBx,FBy;  //local basis vectors per face
+        MatrixXs VBx,VBy;  //local basis vectors per vertex
+        MatrixXs barycenters;
+        VectorXs GaussianCurvature;
 
         //Measures of the scale of a mesh
-        double avgEdgeLength;
-        Eigen::RowVector3d minBox, maxBox;   //bounding box
+        Scalar avgEdgeLength;
+        RowVector3s minBox, maxBox;   //bounding box
 
         int eulerChar;
         int numGenerators;
 
         std::vector<std::vector<int>> boundaryLoops;
 
-        TriMesh(){}
-        ~TriMesh(){}
+        //If true, set_mesh() also fills the padded VE and VF matrices (for compatibility with code that expects them).
+        bool denseOneRings;
+
+        //If true, set_mesh() and update_geometry() run independent construction stages concurrently and split the per-face and per-vertex loops across threads.
+        //The result is identical to the serial construction.
+        bool parallelConstruction;
+
+        //If not INPUT, set_mesh() reorders the vertices and faces of the input for memory locality (see reorder_mesh.h), and all quantities refer to the new order.
+        //vertexOrder, faceOrder and edgeOrder then hold the input index of every vertex, face and edge (edges as enumerated by hedra::polygonal_edge_topology() on the input,
+        //or as given in EV), and edgeOrientation(i)=-1 if edge i is reversed w.r.t. the input edge. For instance, a per-face quantity q computed on the mesh is
+        //mapped back by inputQ.row(faceOrder(i))=q.row(i). When not reordering, these maps are the identity.
+        //update_geometry() takes positions in the input order, like set_mesh(); e.g., mesh.update_geometry(inputV+displacement) with the same inputV that was given to set_mesh().
+        elementOrderTypeEnum elementOrder;
+        Eigen::VectorXi vertexOrder, faceOrder, edgeOrder, edgeOrientation;
+        //Whether vertexOrder is not the identity. Set by set_mesh() (and when reading a mesh cache), and used by update_geometry() rather than elementOrder, which is only the setting for the next set_mesh().
+        bool isReordered;
 
-        void IGL_INLINE set_mesh(const Eigen::MatrixXd& _V,
+        TriMeshT():denseOneRings(false), parallelConstruction(false), elementOrder(elementOrderTypeEnum::INPUT), isReordered(false){}
+        ~TriMeshT(){}
+
+        void IGL_INLINE set_mesh(const MatrixXs& _V,
                                  const Eigen::MatrixXi& _F,
                                  const Eigen::MatrixXi& _EV=Eigen::MatrixXi(),
                                  const Eigen::MatrixXi& _FE=Eigen::MatrixXi(),
                                  const Eigen::MatrixXi& _EF=Eigen::MatrixXi()) {
 
-            V = _V;
-            F = _F;
+            reorder_mesh(_V, _F, elementOrder, V, F, vertexOrder, faceOrder);
+            update_is_reordered();
+
+            //below this size (or when not constructing in parallel) igl::parallel_for runs serially
+            const size_t minParallel = (parallelConstruction ? 1000 : std::numeric_limits<size_t>::max());
+            std::vector<std::future<void>> stages;
+            auto run_stage = [&](const std::function<void()>& stage){
+                if (parallelConstruction)
+                    stages.push_back(std::async(std::launch::async, stage));
+                else
+                    stage();
+            };
+
+            run_stage([&](){igl::triangle_triangle_adjacency(F, TT);});
+            run_stage([&](){igl::boundary_loop(F, boundaryLoops);});
+
             if (_EV.rows() == 0) {
-                igl::edge_topology(V, F, EV, FE, EF);
+                hedra::polygonal_edge_topology(Eigen::VectorXi::Constant(F.rows(),3), F, EV, FE, EF, EFi, FEs, innerEdges);
+                edgeOrder = Eigen::VectorXi::LinSpaced(EV.rows(), 0, EV.rows()-1);
+                edgeOrientation = Eigen::VectorXi::Constant(EV.rows(), 1);
+                if (elementOrder != elementOrderTypeEnum::INPUT){
+                    //the corners of every face are kept by the reordering, and so FE(i,j) is the input edge FE(faceOrder(i),j) of the input
+                    Eigen::MatrixXi inputEV, inputFE, inputEF, inputEFi;
+                    Eigen::MatrixXd inputFEs;
+                    Eigen::VectorXi inputInnerEdges;
+                    hedra::polygonal_edge_topology(Eigen::VectorXi::Constant(_F.rows(),3), _F, inputEV, inputFE, inputEF, inputEFi, inputFEs, inputInnerEdges);
+                    for (int i=0;i<F.rows();i++)
+                        for (int j=0;j<3;j++)
+                            edgeOrder(FE(i,j)) = inputFE(faceOrder(i),j);
+                    for (int i=0;i<EV.rows();i++)
+                        edgeOrientation(i) = (vertexOrder(EV(i,0)) == inputEV(edgeOrder(i),0) ? 1 : -1);
+                }
             } else {
-                EV = _EV;
-                FE = _FE;
-                EF = _EF;
+                //edges keep their input order; only the vertex and face indices are remapped
+                Eigen::VectorXi newVertexIndex(V.rows()), newFaceIndex(F.rows());
+                for (int i=0;i<V.rows();i++)
+                    newVertexIndex(vertexOrder(i))=i;
+                for (int i=0;i<F.rows();i++)
+                    newFaceIndex(faceOrder(i))=i;
+                EV.resize(_EV.rows(), 2);
+                EF.resize(_EF.rows(), 2);
+                FE.resize(_FE.rows(), 3);
+                for (int i=0;i<EV.rows();i++)
+                    for (int j=0;j<2;j++){
+                        EV(i,j) = newVertexIndex(_EV(i,j));
+                        EF(i,j) = (_EF(i,j)==-1 ? -1 : newFaceIndex(_EF(i,j)));
+                    }
+                for (int i=0;i<FE.rows();i++)
+                    FE.row(i) = _FE.row(faceOrder(i));
+                edgeOrder = Eigen::VectorXi::LinSpaced(EV.rows(), 0, EV.rows()-1);
+                edgeOrientation = Eigen::VectorXi::Constant(EV.rows(), 1);
+
+                //computing extra combinatorial information
+                //Relative location of edges within faces
+                EFi = Eigen::MatrixXi::Constant(EF.rows(), 2, -1); // number of an edge inside the face
+                igl::parallel_for(EF.rows(), [&](const int i)
+                {
+                    for (int k = 0; k < 2; k++)
+                    {
+                        if (EF(i, k) == -1)
+                            continue;
+                        for (int j = 0; j < 3; j++)
+                            if (FE(EF(i, k), j) == i)
+                                EFi(i, k) = j;
+                    }
+                }, minParallel);
+
+                //sign of edge within face
+                FEs = Eigen::MatrixXd::Zero(FE.rows(), FE.cols());
+
+                igl::parallel_for(EF.rows(), [&](const int i)
+                {
+                    if(EFi(i, 0) != -1)
+                        FEs(EF(i, 0), EFi(i, 0)) = 1.0;
+                    if(EFi(i,1) != -1)
+                        FEs(EF(i, 1), EFi(i, 1)) = -1.0;
+                }, minParallel);
             }
             std::vector<int> innerEdgesList, boundEdgesList;
             isBoundaryVertex=Eigen::VectorXi::Zero(V.size());
@@ -98,46 +201,9 @@ namespace directional{
 
             }
 
-            //computing extra combinatorial information
-            //Relative location of edges within faces
-            EFi = Eigen::MatrixXi::Constant(EF.rows(), 2, -1); // number of an edge inside the face
-            for(int i = 0; i < EF.rows(); i++)
-            {
-                for (int k = 0; k < 2; k++)
-                {
-                    if (EF(i, k) == -1)
-                        continue;
-                    for (int j = 0; j < 3; j++)
-                        if (FE(EF(i, k), j) == i)
-                            EFi(i, k) = j;
-                }
-            }
-
-            //sign of edge within face
-            FEs = Eigen::MatrixXd::Zero(FE.rows(), FE.cols());
-
-            for(int i = 0; i < EF.rows(); i++)
-            {
-                if(EFi(i, 0) != -1)
-                    FEs(EF(i, 0), EFi(i, 0)) = 1.0;
-                if(EFi(i,1) != -1)
-                    FEs(EF(i, 1), EFi(i, 1)) = -1.0;
-            }
-
             innerEdges = Eigen::Map<Eigen::VectorXi, Eigen::Unaligned>(innerEdgesList.data(), innerEdgesList.size());
             boundEdges = Eigen::Map<Eigen::VectorXi, Eigen::Unaligned>(boundEdgesList.data(), boundEdgesList.size());
-            igl::barycenter(V, F, barycenters);
-            igl::local_basis(V, F, FBx, FBy, faceNormals);
-            igl::triangle_triangle_adjacency(F, TT);
-            igl::boundary_loop(F, boundaryLoops);
-            directional::gaussian_curvature(V,F,isBoundaryVertex, GaussianCurvature);
-            igl::doublearea(V,F,faceAreas);
-            faceAreas.array()/=2.0;
             eulerChar = V.rows() - EV.rows() + F.rows();
-            numGenerators = (2 - eulerChar)/2 - boundaryLoops.size();
-            avgEdgeLength=igl::avg_edge_length(V,F);
-            minBox = V.colwise().minCoeff();
-            maxBox = V.colwise().maxCoeff();
 
             hedra::dcel(Eigen::VectorXi::Constant(F.rows(),3),F,EV,EF,EFi, innerEdges,VH,EH,FH,HV,HE,HF,nextH,prevH,twinH);
             vertexValence=Eigen::VectorXi::Zero(V.rows());
@@ -146,11 +212,16 @@ namespace directional{
                 vertexValence(EV(i,1))++;
             }
 
+            vertexOneRingOffsets.resize(V.rows()+1);
+            vertexOneRingOffsets(0)=0;
+            for (int i=0;i<V.rows();i++)
+                vertexOneRingOffsets(i+1)=vertexOneRingOffsets(i)+vertexValence(i);
+
             //TODO: adapt to boundaries
-            VE.resize(V.rows(),vertexValence.maxCoeff());
-            VF.resize(V.rows(),vertexValence.maxCoeff());
-            for (int i=0;i<V.rows();i++){
-                int counter=0;
+            vertexOneRingEdges.resize(vertexOneRingOffsets(V.rows()));
+            vertexOneRingFaces=Eigen::VectorXi::Constant(vertexOneRingOffsets(V.rows()), -1);
+            igl::parallel_for(V.rows(), [&](const int i){
+                int counter=vertexOneRingOffsets(i);
                 int hebegin = VH(i);
                 if (isBoundaryVertex(i)) //winding up hebegin to the first boundary edge
                     while (twinH(hebegin)!=-1)
@@ -160,41 +231,131 @@ namespace directional{
                 VH(i)=hebegin;
                 int heiterate = hebegin;
                 do {
-                    VE(i, counter) = HE(heiterate);
-                    VF(i, counter++) = HF(heiterate);
+                    vertexOneRingEdges(counter) = HE(heiterate);
+                    vertexOneRingFaces(counter++) = HF(heiterate);
                     if (twinH(prevH(heiterate))==-1) { //last edge before end, adding the next edge
-                        VE(i, counter) = HE(prevH(heiterate));  //note counter is already ahead
+                        vertexOneRingEdges(counter) = HE(prevH(heiterate));  //note counter is already ahead
                         break;
                     }
                     heiterate = twinH(prevH(heiterate));
                 }while(hebegin!=heiterate);
+            }, minParallel);
+
+            if (denseOneRings)
+                compute_dense_one_rings();
+
+            for (int i=0;i<stages.size();i++)
+                stages[i].get();
+
+            numGenerators = (2 - eulerChar)/2 - boundaryLoops.size();
+
+            compute_geometry();
+        }
+
+        //Fills the padded VE and VF matrices from the compressed one-rings. Unused entries are -1.
+        void IGL_INLINE compute_dense_one_rings(){
+            VE=Eigen::MatrixXi::Constant(V.rows(),vertexValence.maxCoeff(),-1);
+            VF=Eigen::MatrixXi::Constant(V.rows(),vertexValence.maxCoeff(),-1);
+            for (int i=0;i<V.rows();i++)
+                for (int j=vertexOneRingOffsets(i);j<vertexOneRingOffsets(i+1);j++){
+                    VE(i,j-vertexOneRingOffsets(i))=vertexOneRingEdges(j);
+                    VF(i,j-vertexOneRingOffsets(i))=vertexOneRingFaces(j);
+                }
+        }
+
+        //Recomputes only the position-dependent quantities (normals, areas, bases, curvature, scale) for new vertex positions, reusing the entire combinatorial structure.
+        //Must be called on a mesh for which set_mesh() was already called, with the same number of vertices.
+        //_V is in the input vertex order (as given to set_mesh()), and is permuted by vertexOrder when the mesh is reordered.
+        void IGL_INLINE update_geometry(const MatrixXs& _V){
+
+            assert(_V.rows()==V.rows() && "update_geometry() cannot change the number of vertices");
+            if (!isReordered)
+                V = _V;
+            else {
+                MatrixXs reorderedV(_V.rows(), _V.cols());  //_V might alias V
+                for (int i=0;i<_V.rows();i++)
+                    reorderedV.row(i) = _V.row(vertexOrder(i));
+                V.swap(reorderedV);
             }
+            compute_geometry();
+        }
 
-            //computing vertex normals by area-weighted aveage of face normals
-            vertexNormals=Eigen::MatrixXd::Zero(V.rows(),3);
-            for (int i=0;i<F.rows();i++)
-                for (int j=0;j<3;j++)
-                    vertexNormals.row(F(i,j)).array()+=faceNormals.row(i).array()*faceAreas(i);
+        //Sets isReordered from vertexOrder.
+        void IGL_INLINE update_is_reordered(){
+            isReordered = false;
+            for (int i=0;i<vertexOrder.size();i++)
+                if (vertexOrder(i)!=i)
+                    isReordered = true;
+        }
+
+        //Computes the position-dependent quantities from the current V.
+        void IGL_INLINE compute_geometry(){
+
+            const size_t minParallel = (parallelConstruction ? 1000 : std::numeric_limits<size_t>::max());
+            std::vector<std::future<void>> stages;
+            auto run_stage = [&](const std::function<void()>& stage){
+                if (parallelConstruction)
+                    stages.push_back(std::async(std::launch::async, stage));
+                else
+                    stage();
+            };
+
+            run_stage([&](){igl::barycenter(V, F, barycenters);});
+            run_stage([&](){igl::local_basis(V, F, FBx, FBy, faceNormals);});
+            run_stage([&](){igl::doublearea(V,F,faceAreas); faceAreas.array()/=Scalar(2);});
+            run_stage([&](){avgEdgeLength=igl::avg_edge_length(V,F);});
+            run_stage([&](){directional::gaussian_curvature(V,F,isBoundaryVertex, GaussianCurvature);});
+            minBox = V.colwise().minCoeff();
+            maxBox = V.colwise().maxCoeff();
+
+            for (int i=0;i<stages.size();i++)
+                stages[i].get();
 
+            //computing vertex normals by area-weighted aveage of face normals
+            vertexNormals=MatrixXs::Zero(V.rows(),3);
+            if ((size_t)V.rows()>=minParallel){
+                //each vertex gathers its incident faces from a vertex-to-face map in ascending face order, which reproduces the summation order of the serial loop
+                Eigen::VectorXi vertexFaceOffsets=Eigen::VectorXi::Zero(V.rows()+1);
+                for (int i=0;i<F.rows();i++)
+                    for (int j=0;j<3;j++)
+                        vertexFaceOffsets(F(i,j)+1)++;
+                for (int i=0;i<V.rows();i++)
+                    vertexFaceOffsets(i+1)+=vertexFaceOffsets(i);
+                Eigen::VectorXi vertexFaces(vertexFaceOffsets(V.rows()));
+                Eigen::VectorXi vertexFaceCounter=vertexFaceOffsets.head(V.rows());
+                for (int i=0;i<F.rows();i++)
+                    for (int j=0;j<3;j++)
+                        vertexFaces(vertexFaceCounter(F(i,j))++)=i;
+
+                igl::parallel_for(V.rows(), [&](const int i){
+                    for (int j=vertexFaceOffsets(i);j<vertexFaceOffsets(i+1);j++)
+                        vertexNormals.row(i).array()+=faceNormals.row(vertexFaces(j)).array()*faceAreas(vertexFaces(j));
+                }, minParallel);
+            } else {
+                for (int i=0;i<F.rows();i++)
+                    for (int j=0;j<3;j++)
+                        vertexNormals.row(F(i,j)).array()+=faceNormals.row(i).array()*faceAreas(i);
+            }
             vertexNormals.rowwise().normalize();
 
             //computing local basis that aligns with the first projected edge of each triangle
             VBx.resize(V.rows(),3);
             VBy.resize(V.rows(),3);
-            for (int i=0;i<V.rows();i++){
-                Eigen::RowVector3d firstEdge = V.row(HV(nextH(VH(i))))-V.row(i);
+            igl::parallel_for(V.rows(), [&](const int i){
+                RowVector3s firstEdge = V.row(HV(nextH(VH(i))))-V.row(i);
                 VBx.row(i)=firstEdge-(firstEdge.dot(vertexNormals.row(i)))*vertexNormals.row(i);
                 VBx.row(i).normalize();
-                Eigen::RowVector3d currx=VBx.row(i);
-                Eigen::RowVector3d currn=vertexNormals.row(i);
+                RowVector3s currx=VBx.row(i);
+                RowVector3s currn=vertexNormals.row(i);
                 VBy.row(i)=currn.cross(currx);
                 VBy.row(i).normalize();
-            }
-
+            }, minParallel);
         }
 
     };
 
+    typedef TriMeshT<double> TriMesh;
+
 }
 
 
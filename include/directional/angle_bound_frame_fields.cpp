@@ -14,6 +14,7 @@
 #include <igl/slice.h>
 #include <igl/polyroots.h>
 #include <igl/colon.h>
+#include <igl/parallel_for.h>
 #include <Eigen/Sparse>
 
 #include <iostream>
@@ -67,7 +68,8 @@ public:
     IGL_INLINE bool solve(const Eigen::VectorXi &isConstrained,
                           const Eigen::PlainObjectBase<DerivedO> &initialSolution,
                           Eigen::PlainObjectBase<DerivedO> &output,
-                          typename DerivedV::Scalar *lambdaOut = NULL);
+                          typename DerivedV::Scalar *lambdaOut = NULL,
+                          const AngleBoundFFIterationCallback<typename DerivedV::Scalar> &iterationCallback = nullptr);
 
   private:
 
@@ -84,6 +86,14 @@ public:
     typename DerivedV::Scalar thetaMin;
     bool doHardConstraints;
 
+    //global-step systems: the slices of the Laplacians by the constraints are fixed in a solve, and the sparsity patterns do not depend on lambda,
+    //so the patterns are analyzed once, and the factorizations are only recomputed when lambda changes.
+    Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > DDAuu, DDAuk, DDBuu, DDBuk, Iuu;
+    Eigen::SparseLU<Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > > solverA, solverB;
+    Eigen::VectorXi isKnown, known, unknown;
+    typename DerivedV::Scalar factorizedLambda;
+    bool isFactorized;
+
     typename DerivedV::Scalar computeAngle(const std::complex<typename DerivedV::Scalar> &u,
                                            const std::complex<typename DerivedV::Scalar> &v);
 //    IGL_INLINE void computeAngles(Eigen::Matrix<typename DerivedV::Scalar, Eigen::Dynamic, 1> &angles);
@@ -102,9 +112,11 @@ public:
                                const Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1>  &Ak,
                                const Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1>  &Bk);
 
-    IGL_INLINE void minQuadWithKnownMini(const Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > &Q,
-                         const Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > &f,
-                         const Eigen::VectorXi isConstrained,
+    IGL_INLINE void precomputeGlobalStep(const Eigen::VectorXi &isConstrained);
+    IGL_INLINE bool factorizeGlobalStep();
+    IGL_INLINE void minQuadWithKnownMini(const Eigen::SparseLU<Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > > &solver,
+                         const Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > &Quk,
+                         const Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> &f,
                          const Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> &xknown,
                                          Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> &x);
     IGL_INLINE void setFieldFromCoefficients();
@@ -318,7 +330,8 @@ lambdaInit(_lambdaInit),
 maxIter(_maxIter),
 lambdaMultFactor(_lambdaMultFactor),
 doHardConstraints(_doHardConstraints),
-thetaMin(_thetaMin)
+thetaMin(_thetaMin),
+isFactorized(false)
 {
   Acoeff.resize(data.numF,1);
   Bcoeff.resize(data.numF,1);
@@ -359,7 +372,8 @@ template<typename DerivedV, typename DerivedF, typename DerivedO>
 IGL_INLINE void igl::AngleBoundFFSolver<DerivedV, DerivedF, DerivedO>::
 localStep()
 {
-  for (int j =0; j<data.numF; ++j)
+  //every face is projected independently
+  igl::parallel_for(data.numF, [&](const int j)
   {
 
     std::complex<typename DerivedV::Scalar> u(pvU(j,0),pvU(j,1));
@@ -396,7 +410,7 @@ localStep()
       pvU.row(j) << real(u1),imag(u1);
       pvV.row(j) << real(v1),imag(v1);
     }
-  }
+  }, 1000);
 
 }
 
@@ -509,25 +523,22 @@ globalStep(const Eigen::Matrix<int, Eigen::Dynamic, 1>  &isConstrained,
 {
   setCoefficientsFromField();
 
-  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > I;
-  igl::speye(data.numF, data.numF, I);
-  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > QA = data.DDA+lambda*I;
-  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > fA = (-2*lambda*Acoeff).sparseView();
+  if (((!isFactorized)||(lambda!=factorizedLambda))&&(!factorizeGlobalStep()))
+    return;
 
-  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > QB = data.DDB+lambda*I;
-  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > fB = (-2*lambda*I*Bcoeff).sparseView();
+  Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> fA = -2*lambda*Acoeff;
+  Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> fB = -2*lambda*Bcoeff;
 
   if(doHardConstraints)
   {
-    minQuadWithKnownMini(QA, fA, isConstrained, Ak, Acoeff);
-    minQuadWithKnownMini(QB, fB, isConstrained, Bk, Bcoeff);
+    minQuadWithKnownMini(solverA, DDAuk, fA, Ak, Acoeff);
+    minQuadWithKnownMini(solverB, DDBuk, fB, Bk, Bcoeff);
   }
   else
   {
-    Eigen::Matrix<int, Eigen::Dynamic, 1>isknown_; isknown_.setZero(data.numF,1);
     Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> xknown_; xknown_.setZero(0,1);
-    minQuadWithKnownMini(QA, fA, isknown_, xknown_, Acoeff);
-    minQuadWithKnownMini(QB, fB, isknown_, xknown_, Bcoeff);
+    minQuadWithKnownMini(solverA, DDAuk, fA, xknown_, Acoeff);
+    minQuadWithKnownMini(solverB, DDBuk, fB, xknown_, Bcoeff);
   }
   setFieldFromCoefficients();
 
@@ -538,7 +549,7 @@ template<typename DerivedV, typename DerivedF, typename DerivedO>
 IGL_INLINE void igl::AngleBoundFFSolver<DerivedV, DerivedF, DerivedO>::
 setFieldFromCoefficients()
 {
-  for (int i = 0; i <data.numF; ++i)
+  igl::parallel_for(data.numF, [&](const int i)
   {
     //    poly coefficients: 1, 0, -Acoeff, 0, Bcoeff
     //    matlab code from roots (given there are no trailing zeros in the polynomial coefficients)
@@ -563,27 +574,27 @@ setFieldFromCoefficients()
     std::complex<typename DerivedV::Scalar> v = roots[maxi];
     pvU(i,0) = real(u); pvU(i,1) = imag(u);
     pvV(i,0) = real(v); pvV(i,1) = imag(v);
-  }
+  }, 1000);
 
 }
 
 template<typename DerivedV, typename DerivedF, typename DerivedO>
 IGL_INLINE void igl::AngleBoundFFSolver<DerivedV, DerivedF, DerivedO>::
-minQuadWithKnownMini(const Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > &Q,
-                     const Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > &f,
-                     const Eigen::VectorXi isConstrained,
-                     const Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> &xknown,
-                     Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> &x)
+precomputeGlobalStep(const Eigen::VectorXi &isConstrained)
 {
-  int N = Q.rows();
+  int N = data.numF;
+  if (doHardConstraints)
+    isKnown = isConstrained;
+  else
+    isKnown.setZero(N,1);
 
-  int nc = xknown.rows();
-  Eigen::VectorXi known; known.setZero(nc,1);
-  Eigen::VectorXi unknown; unknown.setZero(N-nc,1);
+  int nc = isKnown.sum();
+  known.setZero(nc,1);
+  unknown.setZero(N-nc,1);
 
   int indk = 0, indu = 0;
   for (int i = 0; i<N; ++i)
-    if (isConstrained[i])
+    if (isKnown[i])
     {
       known[indk] = i;
       indk++;
@@ -594,41 +605,66 @@ minQuadWithKnownMini(const Eigen::SparseMatrix<std::complex<typename DerivedV::S
       indu++;
     }
 
-  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar>> Quu, Quk;
-
-  igl::slice(Q,unknown, unknown, Quu);
-  igl::slice(Q,unknown, known, Quk);
-
-
-  std::vector<typename Eigen::Triplet<std::complex<typename DerivedV::Scalar> > > tripletList;
+  //the identity has no unknown-known block, so the known parts only come from the Laplacians
+  igl::slice(data.DDA,unknown, unknown, DDAuu);
+  igl::slice(data.DDA,unknown, known, DDAuk);
+  igl::slice(data.DDB,unknown, unknown, DDBuu);
+  igl::slice(data.DDB,unknown, known, DDBuk);
+  igl::speye(N-nc, N-nc, Iuu);
+
+  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > QA = -(DDAuu+Iuu);
+  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > QB = -(DDBuu+Iuu);
+  solverA.analyzePattern(QA);
+  solverB.analyzePattern(QB);
+  isFactorized = false;
+}
 
-  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > fu(N-nc,1);
+template<typename DerivedV, typename DerivedF, typename DerivedO>
+IGL_INLINE bool igl::AngleBoundFFSolver<DerivedV, DerivedF, DerivedO>::
+factorizeGlobalStep()
+{
+  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > QA = -(DDAuu+lambda*Iuu);
+  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > QB = -(DDBuu+lambda*Iuu);
+  solverA.factorize(QA);
+  if(solverA.info()==Eigen::Success)
+    solverB.factorize(QB);
+  isFactorized = ((solverA.info()==Eigen::Success)&&(solverB.info()==Eigen::Success));
+  factorizedLambda = lambda;
+  if (!isFactorized)
+    std::cerr<<"Decomposition failed!"<<std::endl;
+  return isFactorized;
+}
 
-  igl::slice(f,unknown, Eigen::VectorXi::Zero(1,1), fu);
+template<typename DerivedV, typename DerivedF, typename DerivedO>
+IGL_INLINE void igl::AngleBoundFFSolver<DerivedV, DerivedF, DerivedO>::
+minQuadWithKnownMini(const Eigen::SparseLU<Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > > &solver,
+                     const Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > &Quk,
+                     const Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> &f,
+                     const Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> &xknown,
+                     Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> &x)
+{
+  int N = isKnown.rows();
 
-  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar> > rhs = (Quk*xknown).sparseView()+.5*fu;
+  Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> rhs(unknown.rows());
+  for (int i = 0; i<unknown.rows(); ++i)
+    rhs[i] = .5*f[unknown[i]];
+  if (xknown.rows()!=0)
+    rhs += Quk*xknown;
 
-  Eigen::SparseLU< Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar>>> solver;
-  solver.compute(-Quu);
-  if(solver.info()!=Eigen::Success)
-  {
-    std::cerr<<"Decomposition failed!"<<std::endl;
-    return;
-  }
-  Eigen::SparseMatrix<std::complex<typename DerivedV::Scalar>>  b  = solver.solve(rhs);
+  Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> b = solver.solve(rhs);
   if(solver.info()!=Eigen::Success)
   {
     std::cerr<<"Solving failed!"<<std::endl;
     return;
   }
 
-  indk = 0, indu = 0;
+  int indk = 0, indu = 0;
   x.setZero(N,1);
   for (int i = 0; i<N; ++i)
-    if (isConstrained[i])
+    if (isKnown[i])
       x[i] = xknown[indk++];
     else
-      x[i] = b.coeff(indu++,0);
+      x[i] = b(indu++);
 
 }
 
@@ -638,9 +674,11 @@ IGL_INLINE bool igl::AngleBoundFFSolver<DerivedV, DerivedF, DerivedO>::
 solve(const Eigen::VectorXi &isConstrained,
       const Eigen::PlainObjectBase<DerivedO> &initialSolution,
       Eigen::PlainObjectBase<DerivedO> &output,
-      typename DerivedV::Scalar *lambdaOut)
+      typename DerivedV::Scalar *lambdaOut,
+      const AngleBoundFFIterationCallback<typename DerivedV::Scalar> &iterationCallback)
 {
   int numConstrained = isConstrained.sum();
+  precomputeGlobalStep(isConstrained);
   // coefficient values
   Eigen::Matrix<std::complex<typename DerivedV::Scalar>, Eigen::Dynamic, 1> Ak, Bk;
 
@@ -696,6 +734,8 @@ solve(const Eigen::VectorXi &isConstrained,
     oob = getNumOutOfBounds();
 
     bool stoppingCriterion = (oob == 0) ;
+    if (iterationCallback && !iterationCallback(iter, smoothnessValue, oob, lambda))
+      stoppingCriterion = true;
     if (stoppingCriterion)
       break;
     lambda = lambda*lambdaMultFactor;
@@ -748,10 +788,11 @@ IGL_INLINE bool igl::angle_bound_frame_fields(const igl::AngleBoundFFSolverData<
                                             const typename DerivedV::Scalar &lambdaInit,
                                             const typename DerivedV::Scalar &lambdaMultFactor,
                                               const bool doHardConstraints,
-                                            typename DerivedV::Scalar *lambdaOut)
+                                            typename DerivedV::Scalar *lambdaOut,
+                                            const AngleBoundFFIterationCallback<typename DerivedV::Scalar> &iterationCallback)
 {
   igl::AngleBoundFFSolver<DerivedV, DerivedF, DerivedO> cs(csdata, thetaMin, maxIter, lambdaInit, lambdaMultFactor, doHardConstraints);
-  return (cs.solve(isConstrained, initialSolution, output, lambdaOut));
+  return (cs.solve(isConstrained, initialSolution, output, lambdaOut, iterationCallback));
 }
 
 #ifdef IGL_STATIC_LIBRARY
@@ -12,6 +12,7 @@
 
 #include <Eigen/Core>
 #include <vector>
+#include <functional>
 
 namespace igl {
   //todo
@@ -26,6 +27,12 @@ namespace igl {
   template <typename DerivedV, typename DerivedF>
   class AngleBoundFFSolverData;
 
+  // Convergence monitor of the solver, called after every local-global iteration with
+  // (iteration, smoothness energy, number of faces out of the angle bound, lambda).
+  // Returning false stops the iterations.
+  template <typename Scalar>
+  using AngleBoundFFIterationCallback = std::function<bool(int, Scalar, int, Scalar)>;
+
   template <typename DerivedV, typename DerivedF, typename DerivedO>
   IGL_INLINE bool angle_bound_frame_fields(const Eigen::PlainObjectBase<DerivedV> &V,
                                          const Eigen::PlainObjectBase<DerivedF> &F,
@@ -48,7 +55,8 @@ namespace igl {
                                          const typename DerivedV::Scalar &_lambdaInit = 100,
                                          const typename DerivedV::Scalar &_lambdaMultFactor = 1.5,
                                            const bool _doHardConstraints = false,
-                                         typename DerivedV::Scalar *lambdaOut = NULL);
+                                         typename DerivedV::Scalar *lambdaOut = NULL,
+                                         const AngleBoundFFIterationCallback<typename DerivedV::Scalar> &iterationCallback = nullptr);
 
 };
 
@@ -10,10 +10,11 @@
 
 
 #include <Eigen/Core>
-#include <queue>
 #include <vector>
 #include <cmath>
+#include <limits>
 #include <igl/igl_inline.h>
+#include <igl/parallel_for.h>
 #include <directional/CartesianField.h>
 #include <directional/tree.h>
 #include <directional/principal_matching.h>
@@ -21,71 +22,96 @@
 namespace directional
 {
   // Reorders the vectors in a tangent space (preserving CCW direction) so that the prescribed matching across most TB edges is an identity, except for seams.
+  // The combing routes are a breadth-first spanning forest of the uncut adjacencies (through the compressed one-rings, so of any one-ring size, and covering all
+  // connected components). The vectors and the matching are then relabeled in parallel. Combing does not change which vectors are matched, so the effort and
+  // singularities are those of rawField, and are only computed (from the combed matching) when rawField has no effort.
   // Important: if the Raw field in not CCW ordered, the result is unpredictable.
   // Input:
   //  rawField:   a RAW_FIELD uncombed cartesian field object
-  //  _spaceIsCut: #F x |maxOneRing| optionally prescribing the TB edges (corresponding to mesh faces) that must be a seam.
+  //  _spaceIsCut: #F x |maxOneRing| optionally prescribing the TB edges (corresponding to mesh faces) that must be a seam, by their order in the one-ring.
+  //  parallel:   whether to relabel the tangent spaces and adjacencies in parallel.
   // Output:
   //  combedField: the combed field object, also RAW_FIELD
   
-  IGL_INLINE void combing(const directional::CartesianField& rawField,
-                          directional::CartesianField& combedField,
-                          const Eigen::MatrixXi& _spaceIsCut=Eigen::MatrixXi())
+  template<typename Scalar>
+  IGL_INLINE void combing(const directional::CartesianFieldT<Scalar>& rawField,
+                          directional::CartesianFieldT<Scalar>& combedField,
+                          const Eigen::MatrixXi& _spaceIsCut=Eigen::MatrixXi(),
+                          const bool parallel=true)
   {
     using namespace Eigen;
-    combedField.init(*(rawField.tb), fieldTypeEnum::RAW_FIELD, rawField.N);
-    Eigen::MatrixXi spaceIsCut(rawField.intField.rows(),3);
-    if (_spaceIsCut.rows()==0)
-        spaceIsCut.setZero();
-    else
-        spaceIsCut=_spaceIsCut;
-    
-    VectorXi spaceTurns(rawField.intField.rows());
-    
-    //flood-filling through the matching to comb field
-    
-    //dual tree to find combing routes
-    VectorXi visitedSpaces=VectorXi::Constant(rawField.intField.rows(),1,0);
-    std::queue<std::pair<int,int> > spaceMatchingQueue;
-    spaceMatchingQueue.push(std::pair<int,int>(0,0));
-    MatrixXd combedIntField(combedField.intField.rows(), combedField.intField.cols());
-    do{
-      std::pair<int,int> currSpaceMatching=spaceMatchingQueue.front();
-      spaceMatchingQueue.pop();
-      if (visitedSpaces(currSpaceMatching.first))
+    typedef std::complex<Scalar> Complex;
+    const TangentBundleT<Scalar>* tb = rawField.tb;
+    const int N = rawField.N;
+    const int numSpaces = rawField.intField.rows();
+    const size_t minParallel = (parallel ? 1000 : std::numeric_limits<size_t>::max());
+    combedField.init(*tb, fieldTypeEnum::RAW_FIELD, N);
+
+    //flood-filling through the matching to comb field: spaceTurns(i) is the vector of space i that becomes the first one.
+    //The queue is a flat array that every space enters once, when it is first reached (which is the order in which a FIFO queue would first pop it).
+    VectorXi spaceTurns = VectorXi::Constant(numSpaces, -1);
+    std::vector<int> spaceQueue(numSpaces);
+    int queueEnd=0;
+    for (int root=0;root<numSpaces;root++){
+      if (spaceTurns(root)!=-1)
         continue;
-      visitedSpaces(currSpaceMatching.first)=1;
-      
-      //combing field to start from the matching index
-      combedIntField.block(currSpaceMatching.first, 0, 1, 2*(rawField.N-currSpaceMatching.second))=rawField.intField.block(currSpaceMatching.first, 2*currSpaceMatching.second, 1, 2*(rawField.N-currSpaceMatching.second));
-      combedIntField.block(currSpaceMatching.first, 2*(rawField.N-currSpaceMatching.second), 1, 2*currSpaceMatching.second)=rawField.intField.block(currSpaceMatching.first, 0, 1, 2*currSpaceMatching.second);
-      
-      spaceTurns(currSpaceMatching.first)=currSpaceMatching.second;
-      
-      for (int i=0;i<3;i++){
-        int nextMatching=(rawField.matching(rawField.tb->oneRing(currSpaceMatching.first,i)));
-        int nextFace=(rawField.tb->adjSpaces(rawField.tb->oneRing(currSpaceMatching.first,i),0)==currSpaceMatching.first ? rawField.tb->adjSpaces(rawField.tb->oneRing(currSpaceMatching.first,i),1) : rawField.tb->adjSpaces(rawField.tb->oneRing(currSpaceMatching.first,i),0));
-        nextMatching*=(rawField.tb->adjSpaces(rawField.tb->oneRing(currSpaceMatching.first,i),0)==currSpaceMatching.first ? 1.0 : -1.0);
-        nextMatching=(nextMatching+currSpaceMatching.second+10*rawField.N)%rawField.N;  //killing negatives
-        if ((nextFace!=-1)&&(!visitedSpaces(nextFace))&&(!spaceIsCut(currSpaceMatching.first,i)))
-          spaceMatchingQueue.push(std::pair<int,int>(nextFace, nextMatching));
-        
+      spaceTurns(root)=0;
+      spaceQueue[queueEnd++]=root;
+      for (int queueBegin=queueEnd-1;queueBegin<queueEnd;queueBegin++){
+        const int currSpace=spaceQueue[queueBegin];
+        for (int j=tb->oneRingOffsets(currSpace);j<tb->oneRingOffsets(currSpace+1);j++){
+          if ((_spaceIsCut.rows()!=0)&&(_spaceIsCut(currSpace, j-tb->oneRingOffsets(currSpace))))
+            continue;
+          const int adjacency=tb->oneRingAdjacencies(j);
+          const bool isFirst=(tb->adjSpaces(adjacency,0)==currSpace);
+          const int nextSpace=tb->adjSpaces(adjacency, isFirst ? 1 : 0);
+          if ((nextSpace==-1)||(spaceTurns(nextSpace)!=-1))
+            continue;
+          const int nextTurn=(isFirst ? rawField.matching(adjacency) : -rawField.matching(adjacency))+spaceTurns(currSpace);
+          spaceTurns(nextSpace)=((nextTurn%N)+N)%N;  //killing negatives
+          spaceQueue[queueEnd++]=nextSpace;
+        }
+      }
+    }
+
+    //combing field to start from the matching index
+    Matrix<Scalar, Dynamic, Dynamic> combedIntField(numSpaces, 2*N);
+    igl::parallel_for(numSpaces, [&](const int i){
+      for (int j=0;j<N;j++){
+        combedIntField(i,2*j)=rawField.intField(i,2*((j+spaceTurns(i))%N));
+        combedIntField(i,2*j+1)=rawField.intField(i,2*((j+spaceTurns(i))%N)+1);
       }
-      
-    }while (!spaceMatchingQueue.empty());
-    
+    }, minParallel);
     combedField.set_intrinsic_field(combedIntField);
-    combedField.matching.resize(rawField.tb->adjSpaces.rows());
+
     //Combed matching
-    for (int i=0;i<rawField.tb->adjSpaces.rows();i++){
-      if ((rawField.tb->adjSpaces(i,0)==-1)||(rawField.tb->adjSpaces(i,1)==-1))
+    combedField.matching.resize(tb->adjSpaces.rows());
+    igl::parallel_for(tb->adjSpaces.rows(), [&](const int i){
+      if ((tb->adjSpaces(i,0)==-1)||(tb->adjSpaces(i,1)==-1))
         combedField.matching(i)=-1;
       else
-        combedField.matching(i)=(spaceTurns(rawField.tb->adjSpaces(i,0))-spaceTurns(rawField.tb->adjSpaces(i,1))+rawField.matching(i)+1000*rawField.N)%rawField.N;
+        combedField.matching(i)=(((spaceTurns(tb->adjSpaces(i,0))-spaceTurns(tb->adjSpaces(i,1))+rawField.matching(i))%N)+N)%N;
+    }, minParallel);
+
+    //the same vectors are matched, so the effort (sum of the rotation angles of the matched vectors) and the singularities are unchanged
+    if (rawField.effort.size()==tb->adjSpaces.rows()){
+      combedField.effort=rawField.effort;
+      combedField.set_singularities(rawField.singLocalCycles, rawField.singIndices);
+      return;
     }
 
-    //TODO: only update effort.
-    principal_matching(combedField);
+    combedField.effort=Matrix<Scalar, Dynamic, 1>::Zero(tb->adjSpaces.rows());
+    igl::parallel_for(tb->adjSpaces.rows(), [&](const int i){
+      const int s0=tb->adjSpaces(i,0), s1=tb->adjSpaces(i,1);
+      if ((s0==-1)||(s1==-1))
+        return;
+      for (int j=0;j<N;j++){
+        const int k=(j+combedField.matching(i))%N;
+        const Complex transVec=Complex(combedIntField(s0,2*j), combedIntField(s0,2*j+1))*tb->connection(i);
+        combedField.effort(i)+=arg(Complex(combedIntField(s1,2*k), combedIntField(s1,2*k+1))*conj(transVec));
+      }
+    }, minParallel);
+    effort_to_indices(combedField);
   }
 }
 
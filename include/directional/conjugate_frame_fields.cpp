@@ -12,6 +12,7 @@
 #include <directional/polyroots.h>
 #include <directional/polyvector_to_raw.h>
 #include <directional/ccw_reorient_field.h>
+#include <igl/parallel_for.h>
 #include <Eigen/Sparse>
 
 #include <iostream>
@@ -45,6 +46,13 @@ namespace directional {
         int maxIter;
         bool doHardConstraints;
 
+        //global-step factorizations: the system matrices only change with lambda (and the constraints), while the right-hand sides change every iteration
+        Eigen::SparseLU<Eigen::SparseMatrix<std::complex<double> > > solverA, solverB;
+        Eigen::SparseMatrix<std::complex<double> > QukA, QukB;
+        Eigen::VectorXi isKnown, known, unknown;
+        double factorizedLambda;
+        bool isFactorized, isPatternAnalyzed;
+
         IGL_INLINE void localStep();
         IGL_INLINE void getPolyCoeffsForLocalSolve(const Eigen::Matrix<double, 4, 1> &s,
                                                    const Eigen::Matrix<double, 4, 1> &z,
@@ -53,9 +61,12 @@ namespace directional {
         IGL_INLINE void globalStep(const Eigen::Matrix<int, Eigen::Dynamic, 1>  &isConstrained,
                                    const Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1>  &Ak,
                                    const Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1>  &Bk);
-        IGL_INLINE void minQuadWithKnownMini(const Eigen::SparseMatrix<std::complex<double> > &Q,
-                                             const Eigen::SparseMatrix<std::complex<double> > &f,
-                                             const Eigen::VectorXi isConstrained,
+        IGL_INLINE bool factorizeQuadWithKnownMini(const Eigen::SparseMatrix<std::complex<double> > &Q,
+                                                   Eigen::SparseLU<Eigen::SparseMatrix<std::complex<double> > > &solver,
+                                                   Eigen::SparseMatrix<std::complex<double> > &Quk);
+        IGL_INLINE void minQuadWithKnownMini(const Eigen::SparseLU<Eigen::SparseMatrix<std::complex<double> > > &solver,
+                                             const Eigen::SparseMatrix<std::complex<double> > &Quk,
+                                             const Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> &f,
                                              const Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> &xknown,
                                              Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> &x);
         IGL_INLINE void setFieldFromCoefficients();
@@ -77,7 +88,9 @@ IGL_INLINE directional::ConjugateFFSolver::ConjugateFFSolver(const ConjugateFFSo
         lambdaInit(_lambdaInit),
         maxIter(_maxIter),
         lambdaMultFactor(_lambdaMultFactor),
-        doHardConstraints(_doHardConstraints)
+        doHardConstraints(_doHardConstraints),
+        isFactorized(false),
+        isPatternAnalyzed(false)
 {
     Acoeff.resize(data.numF,1);
     Bcoeff.resize(data.numF,1);
@@ -115,11 +128,12 @@ getPolyCoeffsForLocalSolve(const Eigen::Matrix<double, 4, 1> &s,
 
 IGL_INLINE void directional::ConjugateFFSolver::localStep()
 {
-    for (int j =0; j<data.numF; ++j)
+    //every face is solved independently
+    igl::parallel_for(data.numF, [&](const int j)
     {
         Eigen::Matrix<double, 4, 1> xproj; xproj << pvU.row(j).transpose(),pvV.row(j).transpose();
         Eigen::Matrix<double, 4, 1> z = data.UH[j].transpose()*xproj;
-        Eigen::Matrix<double, 4, 1> x;
+        Eigen::Matrix<double, 4, 1> x = xproj;
 
         Eigen::Matrix<double, Eigen::Dynamic, 1> polyCoeff;
         getPolyCoeffsForLocalSolve(data.s[j], z, polyCoeff);
@@ -148,7 +162,7 @@ IGL_INLINE void directional::ConjugateFFSolver::localStep()
 
         pvU.row(j) << x(0),x(1);
         pvV.row(j) << x(2),x(3);
-    }
+    }, 1000);
 }
 
 
@@ -170,25 +184,39 @@ IGL_INLINE void directional::ConjugateFFSolver::globalStep(const Eigen::Matrix<i
 {
     setCoefficientsFromField();
 
-    Eigen::SparseMatrix<std::complex<double> > I;
-    igl::speye(data.numF, data.numF, I);
-    Eigen::SparseMatrix<std::complex<double> > QA = data.DDA+lambda*data.planarityWeight+lambdaOrtho*I;
-    Eigen::SparseMatrix<std::complex<double> > fA = (-2*lambda*data.planarityWeight*Acoeff).sparseView();
+    //refactorizing only when lambda changed since the last iteration
+    if ((!isFactorized)||(lambda!=factorizedLambda))
+    {
+        if (doHardConstraints)
+            isKnown = isConstrained;
+        else
+            isKnown.setZero(data.numF,1);
+
+        Eigen::SparseMatrix<std::complex<double> > I;
+        igl::speye(data.numF, data.numF, I);
+        Eigen::SparseMatrix<std::complex<double> > QA = data.DDA+lambda*data.planarityWeight+lambdaOrtho*I;
+        Eigen::SparseMatrix<std::complex<double> > QB = data.DDB+lambda*data.planarityWeight;
+
+        isFactorized = factorizeQuadWithKnownMini(QA, solverA, QukA) && factorizeQuadWithKnownMini(QB, solverB, QukB);
+        isPatternAnalyzed = isFactorized;  //the sparsity patterns do not depend on lambda
+        factorizedLambda = lambda;
+        if (!isFactorized)
+            return;
+    }
 
-    Eigen::SparseMatrix<std::complex<double> > QB = data.DDB+lambda*data.planarityWeight;
-    Eigen::SparseMatrix<std::complex<double> > fB = (-2*lambda*data.planarityWeight*Bcoeff).sparseView();
+    Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> fA = -2*lambda*data.planarityWeight*Acoeff;
+    Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> fB = -2*lambda*data.planarityWeight*Bcoeff;
 
     if(doHardConstraints)
     {
-        minQuadWithKnownMini(QA, fA, isConstrained, Ak, Acoeff);
-        minQuadWithKnownMini(QB, fB, isConstrained, Bk, Bcoeff);
+        minQuadWithKnownMini(solverA, QukA, fA, Ak, Acoeff);
+        minQuadWithKnownMini(solverB, QukB, fB, Bk, Bcoeff);
     }
     else
     {
-        Eigen::Matrix<int, Eigen::Dynamic, 1>isknown_; isknown_.setZero(data.numF,1);
         Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> xknown_; xknown_.setZero(0,1);
-        minQuadWithKnownMini(QA, fA, isknown_, xknown_, Acoeff);
-        minQuadWithKnownMini(QB, fB, isknown_, xknown_, Bcoeff);
+        minQuadWithKnownMini(solverA, QukA, fA, xknown_, Acoeff);
+        minQuadWithKnownMini(solverB, QukB, fB, xknown_, Bcoeff);
     }
     setFieldFromCoefficients();
 
@@ -197,7 +225,7 @@ IGL_INLINE void directional::ConjugateFFSolver::globalStep(const Eigen::Matrix<i
 
 IGL_INLINE void directional::ConjugateFFSolver::setFieldFromCoefficients()
 {
-    for (int i = 0; i <data.numF; ++i)
+    igl::parallel_for(data.numF, [&](const int i)
     {
         //    poly coefficients: 1, 0, -Acoeff, 0, Bcoeff
         //    matlab code from roots (given there are no trailing zeros in the polynomial coefficients)
@@ -222,25 +250,23 @@ IGL_INLINE void directional::ConjugateFFSolver::setFieldFromCoefficients()
         std::complex<double> v = roots[maxi];
         pvU(i,0) = real(u); pvU(i,1) = imag(u);
         pvV(i,0) = real(v); pvV(i,1) = imag(v);
-    }
+    }, 1000);
 
 }
 
-IGL_INLINE void directional::ConjugateFFSolver::minQuadWithKnownMini(const Eigen::SparseMatrix<std::complex<double> > &Q,
-                                                                     const Eigen::SparseMatrix<std::complex<double> > &f,
-                                                                     const Eigen::VectorXi isConstrained,
-                                                                     const Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> &xknown,
-                                                                     Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> &x)
+IGL_INLINE bool directional::ConjugateFFSolver::factorizeQuadWithKnownMini(const Eigen::SparseMatrix<std::complex<double> > &Q,
+                                                                           Eigen::SparseLU<Eigen::SparseMatrix<std::complex<double> > > &solver,
+                                                                           Eigen::SparseMatrix<std::complex<double> > &Quk)
 {
     int N = Q.rows();
 
-    int nc = xknown.rows();
-    Eigen::VectorXi known; known.setZero(nc,1);
-    Eigen::VectorXi unknown; unknown.setZero(N-nc,1);
+    int nc = isKnown.sum();
+    known.setZero(nc,1);
+    unknown.setZero(N-nc,1);
 
     int indk = 0, indu = 0;
     for (int i = 0; i<N; ++i)
-        if (isConstrained[i])
+        if (isKnown[i])
         {
             known[indk] = i;
             indk++;
@@ -251,41 +277,51 @@ IGL_INLINE void directional::ConjugateFFSolver::minQuadWithKnownMini(const Eigen
             indu++;
         }
 
-    Eigen::SparseMatrix<std::complex<double>> Quu, Quk;
+    Eigen::SparseMatrix<std::complex<double>> Quu;
 
     igl::slice(Q,unknown, unknown, Quu);
     igl::slice(Q,unknown, known, Quk);
 
-
-    std::vector<typename Eigen::Triplet<std::complex<double> > > tripletList;
-
-    Eigen::SparseMatrix<std::complex<double> > fu(N-nc,1);
-
-    igl::slice(f,unknown, Eigen::VectorXi::Zero(1,1), fu);
-
-    Eigen::SparseMatrix<std::complex<double> > rhs = (Quk*xknown).sparseView()+.5*fu;
-
-    Eigen::SparseLU< Eigen::SparseMatrix<std::complex<double>>> solver;
-    solver.compute(-Quu);
+    Quu = -Quu;
+    if (!isPatternAnalyzed)
+        solver.analyzePattern(Quu);
+    solver.factorize(Quu);
     if(solver.info()!=Eigen::Success)
     {
         std::cerr<<"Decomposition failed!"<<std::endl;
-        return;
+        return false;
     }
-    Eigen::SparseMatrix<std::complex<double>>  b  = solver.solve(rhs);
+    return true;
+}
+
+IGL_INLINE void directional::ConjugateFFSolver::minQuadWithKnownMini(const Eigen::SparseLU<Eigen::SparseMatrix<std::complex<double> > > &solver,
+                                                                     const Eigen::SparseMatrix<std::complex<double> > &Quk,
+                                                                     const Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> &f,
+                                                                     const Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> &xknown,
+                                                                     Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> &x)
+{
+    int N = isKnown.rows();
+
+    Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> rhs(unknown.rows());
+    for (int i = 0; i<unknown.rows(); ++i)
+        rhs[i] = .5*f[unknown[i]];
+    if (xknown.rows()!=0)
+        rhs += Quk*xknown;
+
+    Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> b = solver.solve(rhs);
     if(solver.info()!=Eigen::Success)
     {
         std::cerr<<"Solving failed!"<<std::endl;
         return;
     }
 
-    indk = 0, indu = 0;
+    int indk = 0, indu = 0;
     x.setZero(N,1);
     for (int i = 0; i<N; ++i)
-        if (isConstrained[i])
+        if (isKnown[i])
             x[i] = xknown[indk++];
         else
-            x[i] = b.coeff(indu++,0);
+            x[i] = b(indu++);
 
 }
 
@@ -295,6 +331,9 @@ IGL_INLINE double directional::ConjugateFFSolver::solve(const Eigen::VectorXi &i
                                                         Eigen::MatrixXd &output)
 {
     int numConstrained = isConstrained.sum();
+    //the constraints (and therefore the system matrices) may differ from those of a previous solve
+    isFactorized = false;
+    isPatternAnalyzed = false;
     // coefficient values
     Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> Ak, Bk;
 
@@ -0,0 +1,79 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2021 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIRECTIONAL_CONJUGATE_GRADIENT_H
+#define DIRECTIONAL_CONJUGATE_GRADIENT_H
+
+#include <cmath>
+#include <igl/igl_inline.h>
+#include <Eigen/Core>
+
+
+namespace directional {
+
+  //The preconditioners of the iterative solvers of the field-design functions
+  enum class preconditionerEnum{JACOBI, INCOMPLETE_CHOLESKY};
+
+  // Solves a Hermitian (or real symmetric) positive-definite system A*x=b by preconditioned conjugate gradient, where both A and the preconditioner are only given
+  // as functions, so that the system matrix never has to be formed. Memory is a few vectors of the size of x.
+  // Input:
+  //  applyA:         functor (const VectorType& x, VectorType& y) computing y=A*x.
+  //  applyPrecond:   functor (const VectorType& r, VectorType& z) computing z=P^-1*r, for a Hermitian positive-definite preconditioner P.
+  //  b:              right-hand side.
+  //  tolerance:      relative residual |b-A*x|/|b| at which to stop.
+  //  maxIterations:  the maximum number of iterations.
+  // Input/Output:
+  //  x:              the initial guess if it is of the size of b (otherwise zero is used), and the solution.
+  // Output:
+  //  returns true if the tolerance was reached.
+  template<typename VectorType, typename ApplyA, typename ApplyPrecond>
+  IGL_INLINE bool conjugate_gradient(const ApplyA& applyA,
+                                     const ApplyPrecond& applyPrecond,
+                                     const VectorType& b,
+                                     VectorType& x,
+                                     const double tolerance = 1e-10,
+                                     const int maxIterations = 10000)
+  {
+    typedef typename VectorType::Scalar Scalar;
+
+    const double bNorm = b.norm();
+    if (x.size()!=b.size())
+      x = VectorType::Zero(b.size());
+    if (bNorm==0.0){
+      x.setZero();
+      return true;
+    }
+
+    VectorType r(b.size()), z(b.size()), p(b.size()), Ap(b.size());
+    applyA(x, Ap);
+    r = b - Ap;
+    if (r.norm()<=tolerance*bNorm)
+      return true;
+
+    applyPrecond(r, z);
+    p = z;
+    double rz = std::real(r.dot(z));  //conjugate-linear in r; real for a Hermitian preconditioner
+    for (int iteration=0;iteration<maxIterations;iteration++){
+      applyA(p, Ap);
+      const Scalar alpha = Scalar(rz/std::real(p.dot(Ap)));
+      x += alpha*p;
+      r -= alpha*Ap;
+      if (r.norm()<=tolerance*bNorm)
+        return true;
+
+      applyPrecond(r, z);
+      const double rzNew = std::real(r.dot(z));
+      p = z + Scalar(rzNew/rz)*p;
+      rz = rzNew;
+    }
+    return false;
+  }
+
+}
+
+
+#endif
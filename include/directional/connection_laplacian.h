@@ -0,0 +1,65 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2021 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIRECTIONAL_CONNECTION_LAPLACIAN_H
+#define DIRECTIONAL_CONNECTION_LAPLACIAN_H
+
+#include <complex>
+#include <igl/igl_inline.h>
+#include <Eigen/Core>
+#include <directional/TangentBundle.h>
+
+
+namespace directional {
+
+  // Applies the connection Laplacian D^* W D of a tangent bundle without forming it, where (D*x)(i) = transports(i)*x(adjSpaces(i,0)) - x(adjSpaces(i,1)) for every inner
+  // adjacency i, and W = diag(weights). With transports = connection^N and weights = connectionMass, this is the smoothness energy of N-th power fields.
+  // Input:
+  //  tb:           the tangent bundle.
+  //  transports:   #adjSpaces complex transports.
+  //  weights:      #adjSpaces energy weights.
+  //  x:            #T complex values on the tangent spaces.
+  // Output:
+  //  y:            #T values to which D^* W D x is added.
+  IGL_INLINE void connection_laplacian_apply(const TangentBundle& tb,
+                                             const Eigen::VectorXcd& transports,
+                                             const Eigen::VectorXd& weights,
+                                             const Eigen::Ref<const Eigen::VectorXcd>& x,
+                                             Eigen::Ref<Eigen::VectorXcd> y)
+  {
+    for (int i=0;i<tb.adjSpaces.rows();i++){
+      const int s0=tb.adjSpaces(i,0), s1=tb.adjSpaces(i,1);
+      if ((s0==-1)||(s1==-1))
+        continue;  //boundary edge
+      const std::complex<double> wd = weights(i)*(transports(i)*x(s0)-x(s1));
+      y(s0)+=std::conj(transports(i))*wd;
+      y(s1)-=wd;
+    }
+  }
+
+
+  // The diagonal of the connection Laplacian of connection_laplacian_apply(), for Jacobi preconditioning.
+  IGL_INLINE Eigen::VectorXd connection_laplacian_diagonal(const TangentBundle& tb,
+                                                           const Eigen::VectorXcd& transports,
+                                                           const Eigen::VectorXd& weights,
+                                                           const int sizeT)
+  {
+    Eigen::VectorXd diagonal = Eigen::VectorXd::Zero(sizeT);
+    for (int i=0;i<tb.adjSpaces.rows();i++){
+      const int s0=tb.adjSpaces(i,0), s1=tb.adjSpaces(i,1);
+      if ((s0==-1)||(s1==-1))
+        continue;
+      diagonal(s0)+=weights(i)*std::norm(transports(i));
+      diagonal(s1)+=weights(i);
+    }
+    return diagonal;
+  }
+
+}
+
+
+#endif
@@ -11,59 +11,52 @@
 
 #include <vector>
 #include <cmath>
+#include <limits>
+#include <algorithm>
 #include <Eigen/Core>
 #include <igl/igl_inline.h>
+#include <igl/parallel_for.h>
 #include <directional/TriMesh.h>
 #include <directional/CartesianField.h>
 #include <directional/effort_to_indices.h>
 
 namespace directional
 {
-    // Takes a field in raw form and computes both the curl-matching effort and the consequent curl matching on every tangent-space adjacency.
-    // Important: if the Raw field in not CCW ordered, the result is meaningless.
-    // Note: curl is only (future work...) defined for face-based fields.
-    // Input:
-    //  rawField:   RAW_FIELD type field
-    // Output:
-    //  curlNorm:   L2-norm of the curl vector
-    //  rawField:   With input field matching, effort, and singularities computed
-    IGL_INLINE void curl_matching(directional::CartesianField& rawField,
-                                  Eigen::VectorXd& curlNorm)
+    // The curl matching and effort of the inner edges among [begin,end) of a face-based raw field (see curl_matching() below), for a compile-time degree N or Eigen::Dynamic.
+    // The vectors are projected on the edge once, so that the curl of each of the N candidate matchings is a sum of squared differences of fixed-size arrays.
+    template<int N>
+    IGL_INLINE void curl_matching_kernel(const IntrinsicFaceTangentBundle* ftb,
+                                         const Eigen::MatrixXd& edgeVectors,
+                                         directional::CartesianField& rawField,
+                                         Eigen::VectorXd& curlNorm,
+                                         const int begin,
+                                         const int end)
     {
-
         typedef std::complex<double> Complex;
         using namespace Eigen;
         using namespace std;
 
-        //this only works on face-based fields for now
-        assert(rawField.tb->discTangType()==discTangTypeEnum::FACE_SPACES && "This function only supports face-based fields for now.");
-        IntrinsicFaceTangentBundle* ftb = (IntrinsicFaceTangentBundle*)(rawField.tb);
-        rawField.matching.conservativeResize(ftb->mesh->EF.rows());
-        rawField.matching.setConstant(-1);
-        curlNorm.conservativeResize(ftb->mesh->EF.rows());
-
-        MatrixXd edgeVectors(ftb->mesh->EF.rows(), 3);
-        for (int i = 0; i < ftb->mesh->EF.rows(); i++) {
+        Matrix<double, N, 1> edgeProj0, edgeProj1;
+        Matrix<Complex, N, 1> transVecs, vecs;
+        edgeProj0.resize(rawField.N); edgeProj1.resize(rawField.N);
+        transVecs.resize(rawField.N); vecs.resize(rawField.N);
+        for (int i = begin; i < end; i++) {
             if (ftb->mesh->EF(i, 0) == -1 || ftb->mesh->EF(i, 1) == -1)
                 continue;
-            edgeVectors.row(i) = (ftb->mesh->V.row(ftb->mesh->EV(i, 1)) - ftb->mesh->V.row(ftb->mesh->EV(i, 0))).normalized();
 
-        }
+            for (int k=0;k<rawField.N;k++){
+                edgeProj0(k) = edgeVectors.row(i).dot(rawField.extField.template block<1, 3>(ftb->mesh->EF(i, 0), 3*k));
+                edgeProj1(k) = edgeVectors.row(i).dot(rawField.extField.template block<1, 3>(ftb->mesh->EF(i, 1), 3*k));
+            }
 
-        //effort = VectorXd::Zero(rawField.mesh->EF.rows());
-        for (int i = 0; i < ftb->mesh->EF.rows(); i++) {
-            if (ftb->mesh->EF(i, 0) == -1 || ftb->mesh->EF(i, 1) == -1)
-                continue;
-            //computing free coefficient effort (a.k.a. [Diamanti et al. 2014])
-            //Complex freeCoeffEffort(1.0, 0.0);
+            //finding the matching with the smallest curl
             int indexMinFromZero=0;
-            //finding where the 0 vector in EF(i,0) goes to with smallest rotation angle in EF(i,1), computing the effort, and then adjusting the matching to have principal effort.
             double minCurl = 32767000.0;
             for (int j = 0; j < rawField.N; j++) {
                 double currCurl = 0;
                 for (int k=0;k<rawField.N;k++){
-                    RowVector3d vecDiff =rawField.extField.block(ftb->mesh->EF(i, 1), 3 * ((j+k)%rawField.N), 1, 3)-rawField.extField.block(ftb->mesh->EF(i, 0), 3*k, 1, 3);
-                    currCurl +=pow(edgeVectors.row(i).dot(vecDiff),2.0);
+                    const double curlDiff = edgeProj1((j+k)%rawField.N)-edgeProj0(k);
+                    currCurl += curlDiff*curlDiff;
                 }
 
                 if (currCurl < minCurl){
@@ -75,22 +68,67 @@ namespace directional
             rawField.matching(i) =indexMinFromZero;
             curlNorm(i)= sqrt(minCurl);
 
-            //computing the full effort for 0->indexMinFromZero, and readjusting the matching to fit principal effort
-            Complex freeCoeff(1,0);
-            rawField.effort.resize(rawField.matching.size());
+            //computing the full effort for 0->indexMinFromZero
+            const Complex connection = ftb->connection(i);
             for (int j = 0; j < rawField.N; j++) {
-                //RowVector3d vecjf = rawField.extField.block(rawField.adjSpaces(i, 0), 3*j, 1, 3);
-                RowVector2d vecjf = rawField.intField.block(ftb->adjSpaces(i, 0), 2 * j, 1, 2);
-                Complex vecjfc = Complex(vecjf(0),vecjf(1));
-                RowVector2d vecjg = rawField.intField.block(ftb->adjSpaces(i, 1), 2 * (rawField.matching(i)+j+rawField.N)%rawField.N, 1, 2);
-                Complex vecjgc = Complex(vecjg(0),vecjg(1));
-                Complex transvecjfc = vecjfc*ftb->connection(i);
-                freeCoeff *= (vecjgc / transvecjfc);
+                transVecs(j) = Complex(rawField.intField(ftb->adjSpaces(i, 0), 2 * j), rawField.intField(ftb->adjSpaces(i, 0), 2 * j + 1))*connection;
+                vecs(j) = Complex(rawField.intField(ftb->adjSpaces(i, 1), 2 * j), rawField.intField(ftb->adjSpaces(i, 1), 2 * j + 1));
             }
+            Complex freeCoeff(1,0);
+            for (int j = 0; j < rawField.N; j++)
+                freeCoeff *= vecs((rawField.matching(i)+j)%rawField.N)*conj(transVecs(j));
 
             rawField.effort(i) = arg(freeCoeff);
-
         }
+    }
+
+
+    // Takes a field in raw form and computes both the curl-matching effort and the consequent curl matching on every tangent-space adjacency.
+    // Important: if the Raw field in not CCW ordered, the result is meaningless.
+    // Note: curl is only (future work...) defined for face-based fields.
+    // The common degrees (N=1,2,4,6) use fixed-size kernels, and the rest the dynamic one. The edges are processed in parallel blocks (unless parallel==false),
+    // each writing only its own matching, effort and curl, so that the output does not depend on the number of threads.
+    // Input:
+    //  rawField:   RAW_FIELD type field
+    //  parallel:   whether to process the edges in parallel
+    // Output:
+    //  curlNorm:   L2-norm of the curl vector
+    //  rawField:   With input field matching, effort, and singularities computed
+    IGL_INLINE void curl_matching(directional::CartesianField& rawField,
+                                  Eigen::VectorXd& curlNorm,
+                                  const bool parallel = true)
+    {
+        using namespace Eigen;
+
+        //this only works on face-based fields for now
+        assert(rawField.tb->discTangType()==discTangTypeEnum::FACE_SPACES && "This function only supports face-based fields for now.");
+        IntrinsicFaceTangentBundle* ftb = (IntrinsicFaceTangentBundle*)(rawField.tb);
+        rawField.matching.conservativeResize(ftb->mesh->EF.rows());
+        rawField.matching.setConstant(-1);
+        rawField.effort = VectorXd::Zero(ftb->mesh->EF.rows());
+        curlNorm = VectorXd::Zero(ftb->mesh->EF.rows());
+
+        const int blockSize = 1024;
+        const int numBlocks = (ftb->mesh->EF.rows()+blockSize-1)/blockSize;
+        const size_t minParallel = (parallel ? 2 : std::numeric_limits<size_t>::max());
+        MatrixXd edgeVectors(ftb->mesh->EF.rows(), 3);
+        igl::parallel_for(ftb->mesh->EF.rows(), [&](const int i){
+            if (ftb->mesh->EF(i, 0) == -1 || ftb->mesh->EF(i, 1) == -1)
+                return;
+            edgeVectors.row(i) = (ftb->mesh->V.row(ftb->mesh->EV(i, 1)) - ftb->mesh->V.row(ftb->mesh->EV(i, 0))).normalized();
+        }, (parallel ? 1000 : std::numeric_limits<size_t>::max()));
+
+        igl::parallel_for(numBlocks, [&](const int b){
+            const int begin = b*blockSize;
+            const int end = std::min(begin+blockSize, (int)ftb->mesh->EF.rows());
+            switch (rawField.N){
+                case 1: curl_matching_kernel<1>(ftb, edgeVectors, rawField, curlNorm, begin, end); break;
+                case 2: curl_matching_kernel<2>(ftb, edgeVectors, rawField, curlNorm, begin, end); break;
+                case 4: curl_matching_kernel<4>(ftb, edgeVectors, rawField, curlNorm, begin, end); break;
+                case 6: curl_matching_kernel<6>(ftb, edgeVectors, rawField, curlNorm, begin, end); break;
+                default: curl_matching_kernel<Dynamic>(ftb, edgeVectors, rawField, curlNorm, begin, end);
+            }
+        }, minParallel);
 
         //Getting final singularities and their indices
         effort_to_indices(rawField);
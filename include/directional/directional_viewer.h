@@ -182,8 +182,8 @@ namespace directional
             assert(fieldList[meshNum]->tb->discTangType()==discTangTypeEnum::VERTEX_SPACES);
             std::vector<int> selectedFacesList;
             for (int i=0;i<selectedVertices.size();i++)
-                for (int j=0;j<meshList[meshNum]->vertexValence(selectedVertices(i))-(meshList[meshNum]->isBoundaryVertex(selectedVertices(i)) ? 1 : 0);j++)
-                    selectedFacesList.push_back(meshList[meshNum]->VF(selectedVertices(i),j));
+                for (int j=meshList[meshNum]->vertexOneRingOffsets(selectedVertices(i));j<meshList[meshNum]->vertexOneRingOffsets(selectedVertices(i)+1)-(meshList[meshNum]->isBoundaryVertex(selectedVertices(i)) ? 1 : 0);j++)
+                    selectedFacesList.push_back(meshList[meshNum]->vertexOneRingFaces(j));
 
             Eigen::VectorXi selectedFaces(selectedFacesList.size());
             selectedFaces=Eigen::Map<Eigen::VectorXi, Eigen::Unaligned>(selectedFacesList.data(), selectedFacesList.size());
@@ -17,14 +17,106 @@
 #include <igl/edge_topology.h>
 #include <vector>
 #include <set>
+#include <algorithm>
 #include <unordered_map>
 #include "tree.h"
 
 
 namespace directional
 {
+  // Computes the curvature of the dual cycles produced by dual_cycles(). This only depends on the geometry, and so can be reevaluated for new vertex positions without recomputing the cycles.
+  // Input:
+  //  V, F, EV, EF:     the mesh (as in dual_cycles()).
+  //  basisCycles:      #c by #iE basis cycles from dual_cycles()
+  //  vertex2cycle:     #v by 1 map between vertices and cycles from dual_cycles()
+  //  innerEdges:       #iE by 1 inner edges from dual_cycles()
+  // Output:
+  //  cycleCurvature:   #c by 1 curvatures of each cycle
+  template<typename Scalar>
+  IGL_INLINE void dual_cycle_curvatures(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& V,
+                                        const Eigen::MatrixXi& F,
+                                        const Eigen::MatrixXi& EV,
+                                        const Eigen::MatrixXi& EF,
+                                        const Eigen::SparseMatrix<double>& basisCycles,
+                                        const Eigen::VectorXi& vertex2cycle,
+                                        const Eigen::VectorXi& innerEdges,
+                                        Eigen::Matrix<Scalar, Eigen::Dynamic, 1>& cycleCurvature)
+  {
+    using namespace Eigen;
+    using namespace std;
+
+    //Correct computation of cycle curvature by adding angles
+    //getting corner angle sum
+    Matrix<Scalar, Dynamic, 1> allAngles(3*F.rows());
+    for (int i=0;i<F.rows();i++){
+      for (int j=0;j<3;j++){
+        Matrix<Scalar, 1, 3> edgeVec12=V.row(F(i,(j+1)%3))-V.row(F(i,j));
+        Matrix<Scalar, 1, 3> edgeVec13=V.row(F(i,(j+2)%3))-V.row(F(i,j));
+        allAngles(3*i+j)=acos(edgeVec12.normalized().dot(edgeVec13.normalized()));
+      }
+    }
+
+    //for each cycle, summing up all its internal angles negatively  + either 2*pi*|cycle| for internal cycles or pi*|cycle| for boundary cycles.
+    //Inner-vertex cycles are exactly those that a single vertex maps to (boundary cycles have all their vertices mapped to them, and generators none).
+    cycleCurvature=Matrix<Scalar, Dynamic, 1>::Zero(basisCycles.rows());
+    VectorXi cycleVertexCount=VectorXi::Zero(basisCycles.rows());
+    for (int i=0;i<vertex2cycle.size();i++)
+      if ((vertex2cycle(i)>=0)&&(vertex2cycle(i)<basisCycles.rows()))
+        cycleVertexCount(vertex2cycle(i))++;
+    VectorXi isBigCycle=(cycleVertexCount.array()!=1).cast<int>();
+
+    //getting the 4 corners of each edge to allocated later to cycles according to the sign of the edge.
+    MatrixXi edgeCorners(innerEdges.size(),4);
+    for (int i=0;i<innerEdges.rows();i++){
+      int inFace1=0;
+      while (F(EF(innerEdges(i),0),inFace1)!=EV(innerEdges(i),0))
+        inFace1=(inFace1+1)%3;
+      int inFace2=0;
+      while (F(EF(innerEdges(i),1),inFace2)!=EV(innerEdges(i),1))
+        inFace2=(inFace2+1)%3;
+
+      edgeCorners(i,0)=EF(innerEdges(i),0)*3+inFace1;
+      edgeCorners(i,1)=EF(innerEdges(i),1)*3+(inFace2+1)%3;
+      edgeCorners(i,2)=EF(innerEdges(i),0)*3+(inFace1+1)%3;
+      edgeCorners(i,3)=EF(innerEdges(i),1)*3+inFace2;
+    }
+
+    //every corner and vertex is counted once per cycle, by marking it with the last cycle that used it. The corner angles are subtracted in ascending corner order.
+    SparseMatrix<double, RowMajor> rowCycles=basisCycles;
+    VectorXi cornerMark=VectorXi::Constant(3*F.rows(),-1);
+    VectorXi vertexMark=VectorXi::Constant(EV.maxCoeff()+1,-1);
+    vector<int> cycleCorners;
+    for (int i=0;i<rowCycles.outerSize();i++){
+      int numCycleVertices=0;
+      cycleCorners.clear();
+      for (SparseMatrix<double, RowMajor>::InnerIterator it(rowCycles,i); it; ++it){
+        for (int j=0;j<2;j++){
+          int corner=edgeCorners(it.col(),(it.value()<0 ? 0 : 2)+j);
+          if (cornerMark(corner)!=i){
+            cornerMark(corner)=i;
+            cycleCorners.push_back(corner);
+          }
+        }
+        int vertex=EV(innerEdges(it.col()), it.value()<0 ? 0 : 1);
+        if (vertexMark(vertex)!=i){
+          vertexMark(vertex)=i;
+          numCycleVertices++;
+        }
+      }
+
+      if (isBigCycle(i))
+        cycleCurvature(i)=igl::PI*(double)numCycleVertices;
+      else
+        cycleCurvature(i)=2.0*igl::PI;
+      std::sort(cycleCorners.begin(), cycleCorners.end());
+      for (int j=0;j<cycleCorners.size();j++)
+        cycleCurvature(i)-=allAngles(cycleCorners[j]);
+    }
+  }
+
   // Creates the set of independent dual cycles (closed loops of connected faces that cannot be morphed to each other) on a mesh. Primarily used for index prescription.
   // The basis cycle matrix first contains #V-#b cycles for every inner vertex (by order), then #b boundary cycles, and finally 2*g generator cycles around all handles. Total #c cycles.The cycle matrix sums information on the dual edges between the faces, and is indexed into the inner edges alone (excluding boundary)
+  // The generator cycles are found by a tree-cotree decomposition, and the whole construction works on flat arrays.
   //input:
   //  V: #V by 3 vertices.
   //  F: #F by 3 triangles.
@@ -36,12 +128,13 @@ namespace directional
   //  vertex2cycle:     #v by 1 map between vertex and corresponding cycle (for comfort of input from the user's side; inner vertices map to their cycles, boundary vertices to the bigger boundary cycle.
   //  innerEdges:       #iE by 1 the subset of #EV that are inner edges, and with the same ordering as the columns of basisCycles.
   
-  IGL_INLINE void dual_cycles(const Eigen::MatrixXd& V,
+  template<typename Scalar>
+  IGL_INLINE void dual_cycles(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& V,
                               const Eigen::MatrixXi& F,
                               const Eigen::MatrixXi& EV,
                               const Eigen::MatrixXi& EF,
                               Eigen::SparseMatrix<double>& basisCycles,
-                              Eigen::VectorXd& cycleCurvature,
+                              Eigen::Matrix<Scalar, Eigen::Dynamic, 1>& cycleCurvature,
                               Eigen::VectorXi& vertex2cycle,
                               Eigen::VectorXi& innerEdges)
   {
@@ -57,244 +150,150 @@ namespace directional
     int numBoundaries=boundaryLoops.size();
     int numGenerators=2-numBoundaries-eulerChar;
     
-    vector<Triplet<double> > basisCycleTriplets(EV.rows() * 2);
-    
-    //all 1-ring cycles, including boundaries
-    for (int i = 0; i < EV.rows(); i++) {
-      basisCycleTriplets.push_back(Triplet<double>(EV(i, 0), i, -1.0));
-      basisCycleTriplets.push_back(Triplet<double>(EV(i, 1), i, 1.0));
-    }
-    
-    //Creating boundary cycles by building a matrix the sums up boundary loops and zeros out boundary vertex cycles - it will be multiplied from the left to basisCyclesMat
     VectorXi isBoundary(V.rows()); isBoundary.setZero();
     for (int i=0;i<boundaryLoops.size();i++)
       for (int j=0;j<boundaryLoops[i].size();j++)
         isBoundary(boundaryLoops[i][j])=1;
-    
+
     VectorXi pureInnerEdgeMask=VectorXi::Constant(EV.rows(),1);
     for (int i=0;i<EV.rows();i++)
       if ((isBoundary(EV(i,0)))||(isBoundary(EV(i,1))))
         pureInnerEdgeMask(i)=0;
-    
+
+    //the cycles of inner vertices come first, and then the boundary loops. The cycles of every vertex are stored compressed: its own cycle if inner, or the loops it is on if boundary.
+    int numInnerVertices=0;
+    for (int i=0;i<numV;i++)
+      if (!isBoundary(i))
+        vertex2cycle(i)=numInnerVertices++;
+
+    VectorXi vertexCycleOffsets=VectorXi::Zero(numV+1);
+    for (int i=0;i<numV;i++)
+      if (!isBoundary(i))
+        vertexCycleOffsets(i+1)++;
+    for (int i=0;i<boundaryLoops.size();i++)
+      for (int j=0;j<boundaryLoops[i].size();j++)
+        vertexCycleOffsets(boundaryLoops[i][j]+1)++;
+    for (int i=0;i<numV;i++)
+      vertexCycleOffsets(i+1)+=vertexCycleOffsets(i);
+
+    VectorXi vertexCycles(vertexCycleOffsets(numV));
+    VectorXi vertexCycleCounter=vertexCycleOffsets.head(numV);
+    for (int i=0;i<numV;i++)
+      if (!isBoundary(i))
+        vertexCycles(vertexCycleCounter(i)++)=vertex2cycle(i);
+    for (int i=0;i<boundaryLoops.size();i++)
+      for (int j=0;j<boundaryLoops[i].size();j++){
+        vertexCycles(vertexCycleCounter(boundaryLoops[i][j])++)=numInnerVertices+i;
+        vertex2cycle(boundaryLoops[i][j])=numInnerVertices+i;
+      }
+
+    //the columns are the edges that do not lie entirely on the boundary
+    vector<int> innerEdgesList;
+    VectorXi edge2Column=VectorXi::Constant(EV.rows(),-1);
+    for (int i=0;i<EV.rows();i++)
+      if (!((isBoundary(EV(i,0)))&&(isBoundary(EV(i,1))))){
+        edge2Column(i)=innerEdgesList.size();
+        innerEdgesList.push_back(i);
+      }
+
+    //all 1-ring cycles, including boundaries
+    vector<Triplet<double> > basisCycleTriplets;
+    basisCycleTriplets.reserve(2*innerEdgesList.size());
+    for (int i=0;i<innerEdgesList.size();i++){
+      int currEdge=innerEdgesList[i];
+      for (int j=vertexCycleOffsets(EV(currEdge,0));j<vertexCycleOffsets(EV(currEdge,0)+1);j++)
+        basisCycleTriplets.push_back(Triplet<double>(vertexCycles(j), i, -1.0));
+      for (int j=vertexCycleOffsets(EV(currEdge,1));j<vertexCycleOffsets(EV(currEdge,1)+1);j++)
+        basisCycleTriplets.push_back(Triplet<double>(vertexCycles(j), i, 1.0));
+    }
+
     int currGeneratorCycle=0;
-    int currBoundaryCycle=0;
-    
-    if ((numGenerators!=0)/*||(numBoundaries!=0)*/){
+
+    if (numGenerators!=0){
+      //tree co-tree: a primal spanning tree of the pure inner edges, and a dual spanning tree of the faces through the remaining edges
       MatrixXi reducedEV(EV);
       for (int i = 1; i < reducedEV.rows(); i++)
         if(isBoundary(reducedEV(i,0)) || isBoundary(reducedEV(i, 1)))
           reducedEV(i,0) = -1;
-      
+
       VectorXi primalTreeEdges, primalTreeFathers;
       VectorXi dualTreeEdges, dualTreeFathers;
       tree(reducedEV, primalTreeEdges, primalTreeFathers);
-      //creating a set of dual edges that do not cross edges in the primal tree
-      VectorXi fullIndices = VectorXi::LinSpaced(EV.rows(), 0, EV.rows() - 1);
-      VectorXi reducedEFIndices, inFullIndices;
-      MatrixXi reducedEF;
-      igl::setdiff(fullIndices, primalTreeEdges, reducedEFIndices, inFullIndices);
-      VectorXi Two = VectorXi::LinSpaced(2, 0, 1);
-      
-      igl::slice(EF, reducedEFIndices, Two, reducedEF);
+
+      //dual edges that cross edges in the primal tree are masked out, so the dual tree is indexed into EF directly
+      MatrixXi reducedEF(EF);
+      for (int i = 0; i < primalTreeEdges.size(); i++)
+        reducedEF.row(primalTreeEdges(i)).setConstant(-1);
       tree(reducedEF, dualTreeEdges, dualTreeFathers);
-      //converting dualTreeEdges from reducedEF to EF
-      for (int i = 0; i < dualTreeEdges.size(); i++)
-        dualTreeEdges(i) = inFullIndices(dualTreeEdges(i));
-      
-      for (int i = 0; i < dualTreeFathers.size(); i++)
-        if (dualTreeFathers(i) != -1 && dualTreeFathers(i) != -2)
-          dualTreeFathers(i) = inFullIndices(dualTreeFathers(i));
-      
+
       //building tree co-tree based homological cycles
       //finding dual edge which are not in the tree, and following their faces to the end
       VectorXi isinTree = VectorXi::Zero(EF.rows());
-      for (int i = 0; i < dualTreeEdges.size(); i++) {
+      for (int i = 0; i < dualTreeEdges.size(); i++)
         isinTree(dualTreeEdges(i)) = 1;
-      }
-      for (int i = 0; i < primalTreeEdges.size(); i++) {
+      for (int i = 0; i < primalTreeEdges.size(); i++)
         isinTree(primalTreeEdges(i)) = 1;
-      }
-      
+
+      VectorXi visitedOnce = VectorXi::Zero(EF.rows());  //used to remove the tail from the LCA to the root; reset after every cycle
+      vector<int> candidateEdges;
+      vector<double> candidateSigns;
       for (int i = 0; i < isinTree.size(); i++) {
         if (isinTree(i))
           continue;
-        
-        //std::cout<<"New Cycle"<<std::endl;
+
         //otherwise, follow both end faces to the root and this is the dual cycle
         if (EF(i, 0) == -1 || EF(i, 1) == -1)
           continue;
-        std::vector<Triplet<double> > candidateTriplets;
-        //candidateTriplets.push_back(Triplet<double>(0, i, 1.0));
-        Vector2i currLeaves; currLeaves << EF(i, 0), EF(i, 1);
-        VectorXi visitedOnce = VectorXi::Zero(EF.rows());  //used to remove the tail from the LCA to the root
-        bool isBoundaryCycle=true;
-        for (int i = 0; i < 2; i++) { //on leaves
-          int currTreeEdge = -1;  //indexing within dualTreeEdges
-          int currFace = currLeaves(i);
-          currTreeEdge = dualTreeFathers(currFace);
+
+        candidateEdges.clear();
+        candidateSigns.clear();
+        for (int k = 0; k < 2; k++) { //on leaves
+          int currFace = EF(i, k);
+          int currTreeEdge = dualTreeFathers(currFace);
           if (currTreeEdge == -2)
-          {
             break;
-          }
 
           while (currTreeEdge != -1) {
-            //std::cout<<"currTreeEdge: "<<currTreeEdge<<"\n"<<std::endl;
             //determining orientation of current edge vs. face
-            double sign = ((EF(currTreeEdge, 0) == currFace) != (i == 0) ? 1.0 : -1.0);
+            candidateSigns.push_back((EF(currTreeEdge, 0) == currFace) != (k == 0) ? 1.0 : -1.0);
+            candidateEdges.push_back(currTreeEdge);
             visitedOnce(currTreeEdge) = 1 - visitedOnce(currTreeEdge);
-            candidateTriplets.push_back(Triplet<double>(0, currTreeEdge, sign));
             currFace = (EF(currTreeEdge, 0) == currFace ? EF(currTreeEdge, 1) : EF(currTreeEdge, 0));
             currTreeEdge = dualTreeFathers(currFace);
           }
         }
 
-        //only putting in dual edges that are below the LCA
-        for (int i=0;i<candidateTriplets.size();i++)
-          if ((visitedOnce(candidateTriplets[i].col()))&&(pureInnerEdgeMask(candidateTriplets[i].col())))
+        //only the dual edges that are below the LCA are in the cycle. If none of them is purely inner, this is a boundary cycle, which is already covered by the boundary loops.
+        bool isBoundaryCycle=true;
+        for (int j=0;j<candidateEdges.size();j++)
+          if ((visitedOnce(candidateEdges[j]))&&(pureInnerEdgeMask(candidateEdges[j])))
             isBoundaryCycle=false;
-        
-        if (isBoundaryCycle)
-          continue; //ignoring those
-        
-        int currRow = (isBoundaryCycle ? numV+currBoundaryCycle : numV+currGeneratorCycle);
-        (isBoundaryCycle ? currBoundaryCycle++ : currGeneratorCycle++);
-        
-        basisCycleTriplets.push_back(Triplet<double>(currRow, i, 1.0));
-        for (size_t i = 0; i < candidateTriplets.size(); i++)
-          if (visitedOnce(candidateTriplets[i].col())){
-            Triplet<double> trueTriplet(currRow,candidateTriplets[i].col(), candidateTriplets[i].value());
-            basisCycleTriplets.push_back(trueTriplet);
-          }
+
+        if (!isBoundaryCycle){
+          int currRow = numInnerVertices+numBoundaries+currGeneratorCycle++;
+          if (edge2Column(i)!=-1)
+            basisCycleTriplets.push_back(Triplet<double>(currRow, edge2Column(i), 1.0));
+          for (int j = 0; j < candidateEdges.size(); j++)
+            if ((visitedOnce(candidateEdges[j]))&&(edge2Column(candidateEdges[j])!=-1))
+              basisCycleTriplets.push_back(Triplet<double>(currRow, edge2Column(candidateEdges[j]), candidateSigns[j]));
+        }
+
+        for (int j=0;j<candidateEdges.size();j++)
+          visitedOnce(candidateEdges[j])=0;
       }
-      //assert(currBoundaryCycle==numBoundaries && currGeneratorCycle==numGenerators);
     }
-    
+
     numGenerators =currGeneratorCycle;
-    
-    SparseMatrix<double> sumBoundaryLoops(numV+numBoundaries+numGenerators,numV+numGenerators);
-    vector<Triplet<double>> sumBoundaryLoopsTriplets;
-    vector<int> innerVerticesList, innerEdgesList;
-    VectorXi remainRows, remainColumns;
-    
-    for (int i=0;i<numV;i++){
-      sumBoundaryLoopsTriplets.push_back(Triplet<double>(i, i,1.0-isBoundary[i]));
-      if (!isBoundary(i)){
-        innerVerticesList.push_back(i);
-        vertex2cycle(i)=innerVerticesList.size()-1;
-      }
-    }
-    
-    for (int i=0;i<EV.rows();i++)
-      if (!((isBoundary(EV(i,0)))&&(isBoundary(EV(i,1)))))
-        innerEdgesList.push_back(i);
-    
-    //summing up boundary loops
-    for (int i=0;i<boundaryLoops.size();i++)
-      for (int j=0;j<boundaryLoops[i].size();j++){
-        sumBoundaryLoopsTriplets.push_back(Triplet<double>(numV+i, boundaryLoops[i][j],1.0));
-        vertex2cycle(boundaryLoops[i][j])=innerVerticesList.size()+i;
-      }
-    
-    
-    //just passing generators through;
-    for (int i=numV;i<numV+numGenerators;i++)
-      sumBoundaryLoopsTriplets.push_back(Triplet<double>(i, i,1.0));
-    
-    sumBoundaryLoops.setFromTriplets(sumBoundaryLoopsTriplets.begin(), sumBoundaryLoopsTriplets.end());
-    
-    basisCycles.resize(numV+numGenerators, EV.rows());
+
+    basisCycles.resize(numInnerVertices+numBoundaries+numGenerators, innerEdgesList.size());
     basisCycles.setFromTriplets(basisCycleTriplets.begin(), basisCycleTriplets.end());
-    basisCycles=sumBoundaryLoops*basisCycles;
-    
-    //removing rows and columns
-    remainRows.resize(innerVerticesList.size()+numBoundaries+numGenerators);
-    remainColumns.resize(innerEdgesList.size());
-    for (int i=0;i<innerVerticesList.size();i++)
-      remainRows(i)=innerVerticesList[i];
-    
-    for (int i=0;i<numBoundaries+numGenerators;i++)
-      remainRows(innerVerticesList.size()+i)=numV+i;
-    
-    for (int i=0;i<innerEdgesList.size();i++)
-      remainColumns(i)=innerEdgesList[i];
-    
-    //creating slicing matrices
-    std::vector<Triplet<double> > rowSliceTriplets, colSliceTriplets;
-    for (int i=0;i<remainRows.size();i++)
-      rowSliceTriplets.push_back(Triplet<double>(i, remainRows(i), 1.0));
-    for (int i=0;i<remainColumns.size();i++)
-      colSliceTriplets.push_back(Triplet<double>(remainColumns(i), i, 1.0));
-    
-    SparseMatrix<double> rowSliceMat(remainRows.rows(), basisCycles.rows());
-    rowSliceMat.setFromTriplets(rowSliceTriplets.begin(), rowSliceTriplets.end());
-    
-    SparseMatrix<double> colSliceMat(basisCycles.cols(), remainColumns.rows());
-    colSliceMat.setFromTriplets(colSliceTriplets.begin(), colSliceTriplets.end());
-    
-    basisCycles=rowSliceMat*basisCycles*colSliceMat;
-    
+
     innerEdges.conservativeResize(innerEdgesList.size());
     for (int i=0;i<innerEdgesList.size();i++)
       innerEdges(i)=innerEdgesList[i];
-    
-    //computing cycle curvatures
-    Eigen::MatrixXd B1, B2, B3;
-    igl::local_basis(V, F, B1, B2, B3);
-    
-    //Correct computation of cycle curvature by adding angles
-    //getting corner angle sum
-    VectorXd allAngles(3*F.rows());
-    for (int i=0;i<F.rows();i++){
-      for (int j=0;j<3;j++){
-        RowVector3d edgeVec12=V.row(F(i,(j+1)%3))-V.row(F(i,j));
-        RowVector3d edgeVec13=V.row(F(i,(j+2)%3))-V.row(F(i,j));
-        allAngles(3*i+j)=acos(edgeVec12.normalized().dot(edgeVec13.normalized()));
-      }
-    }
-    
-    //for each cycle, summing up all its internal angles negatively  + either 2*pi*|cycle| for internal cycles or pi*|cycle| for boundary cycles.
-    cycleCurvature=VectorXd::Zero(basisCycles.rows());
-    VectorXi isBigCycle=VectorXi::Ones(basisCycles.rows());  //TODO: retain it rather then reverse-engineer...
 
-    for (int i=0;i<V.rows();i++)  //inner cycles
-      if (!isBoundary(i))
-        isBigCycle(vertex2cycle(i))=0;
-    
-    //getting the 4 corners of each edge to allocated later to cycles according to the sign of the edge.
-    vector<set<int>> cornerSets(basisCycles.rows());
-    vector<set<int>> vertexSets(basisCycles.rows());
-    MatrixXi edgeCorners(innerEdges.size(),4);
-    for (int i=0;i<innerEdges.rows();i++){
-      int inFace1=0;
-      while (F(EF(innerEdges(i),0),inFace1)!=EV(innerEdges(i),0))
-        inFace1=(inFace1+1)%3;
-      int inFace2=0;
-      while (F(EF(innerEdges(i),1),inFace2)!=EV(innerEdges(i),1))
-        inFace2=(inFace2+1)%3;
-      
-      edgeCorners(i,0)=EF(innerEdges(i),0)*3+inFace1;
-      edgeCorners(i,1)=EF(innerEdges(i),1)*3+(inFace2+1)%3;
-      edgeCorners(i,2)=EF(innerEdges(i),0)*3+(inFace1+1)%3;
-      edgeCorners(i,3)=EF(innerEdges(i),1)*3+inFace2;
-    }
-    
-    for (int k=0; k<basisCycles.outerSize(); ++k)
-      for (SparseMatrix<double>::InnerIterator it(basisCycles,k); it; ++it){
-        cornerSets[it.row()].insert(edgeCorners(it.col(),it.value()<0 ? 0 : 2));
-        cornerSets[it.row()].insert(edgeCorners(it.col(),it.value()<0 ? 1 : 3));
-        vertexSets[it.row()].insert(EV(innerEdges(it.col()), it.value()<0 ? 0 : 1));
-      }
-    
-    for (int i=0;i<cornerSets.size();i++){
-      if (isBigCycle(i))
-        cycleCurvature(i)=igl::PI*(double)(vertexSets[i].size());
-      else
-        cycleCurvature(i)=2.0*igl::PI;
-      for (set<int>::iterator si=cornerSets[i].begin();si!=cornerSets[i].end();si++)
-        cycleCurvature(i)-=allAngles(*si);
-    }
-     
-    
+    dual_cycle_curvatures(V, F, EV, EF, basisCycles, vertex2cycle, innerEdges, cycleCurvature);
+
     /***********************Deprecated***************************/
     //Explanation: currently computing holonomy as curvature.
     /*VectorXd edgeParallelAngleChange(basisCycles.cols());  //the difference in the angle representation of edge i from EF(i,0) to EF(i,1)
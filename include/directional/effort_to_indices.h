@@ -10,6 +10,8 @@
 
 #include <vector>
 #include <cmath>
+#include <utility>
+#include <algorithm>
 #include <Eigen/Core>
 #include <igl/igl_inline.h>
 #include <igl/boundary_loop.h>
@@ -45,15 +47,16 @@ namespace directional
     }
 
 
-    // version that accepts a cartesian field object and operates on it as input and output.
-    IGL_INLINE void effort_to_indices(directional::CartesianField& field)
+    // version that accepts a cartesian field object and operates on it as input and output (the indices are always computed in double precision).
+    template<typename Scalar>
+    IGL_INLINE void effort_to_indices(directional::CartesianFieldT<Scalar>& field)
     {
         //field.effort = Eigen::VectorXd::Zero(field.adjSpaces.rows());
         Eigen::VectorXd effortInner(field.tb->innerAdjacencies.size());
         for (int i=0;i<field.tb->innerAdjacencies.size();i++)
             effortInner(i)=field.effort(field.tb->innerAdjacencies(i));
         Eigen::VectorXi fullIndices;
-        directional::effort_to_indices(field.tb->cycles, effortInner, field.tb->cycleCurvatures, field.N, fullIndices);
+        directional::effort_to_indices(field.tb->cycles, effortInner, field.tb->cycleCurvatures.template cast<double>().eval(), field.N, fullIndices);
 
         Eigen::VectorXi indices(field.tb->local2Cycle.size());
         for (int i=0;i<field.tb->local2Cycle.size();i++)
@@ -75,6 +78,86 @@ namespace directional
         }
         field.set_singularities(singCycles, singIndices);
     }
+
+
+    // Incremental version of effort_to_indices() above, for a field whose effort only changed on a few adjacencies (e.g., after an interactive edit and a
+    // partial re-matching). The cycles through the changed adjacencies are read from their columns of tb->cycles (the rows of its transpose), and each changes its
+    // index by the (integer) sum of the effort changes around it, so that singLocalCycles and singIndices are updated in time proportional to the edit.
+    // Requires the singularities to be up to date with the previous effort (as set by effort_to_indices()), and falls back to the full computation if
+    // the bundle has no cycle2Local map.
+    // Input:
+    //  changedAdjacencies: #k indices into adjSpaces whose effort has changed (boundary adjacencies are ignored).
+    //  prevEffort:         #k the effort of changedAdjacencies before the change.
+    template<typename Scalar>
+    IGL_INLINE void effort_to_indices(directional::CartesianFieldT<Scalar>& field,
+                                      const Eigen::VectorXi& changedAdjacencies,
+                                      const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>& prevEffort)
+    {
+        using namespace std;
+        const TangentBundleT<Scalar>* tb = field.tb;
+        if (tb->cycle2LocalOffsets.size()!=tb->cycles.rows()+1){
+            effort_to_indices(field);
+            return;
+        }
+
+        //summing the effort changes into the cycles of the changed adjacencies (innerAdjacencies are ascending, as the columns of the cycles)
+        vector<pair<int, int>> changes;  //(adjacency, position in changedAdjacencies), so that repeated adjacencies are only counted once
+        for (int k=0;k<changedAdjacencies.size();k++)
+            changes.push_back(make_pair(changedAdjacencies(k), k));
+        sort(changes.begin(), changes.end());
+        vector<pair<int, double>> cycleChanges;
+        for (int k=0;k<changes.size();k++){
+            if ((k>0)&&(changes[k].first==changes[k-1].first))
+                continue;
+            const int* innerAdjacency = lower_bound(tb->innerAdjacencies.data(), tb->innerAdjacencies.data()+tb->innerAdjacencies.size(), changes[k].first);
+            if ((innerAdjacency==tb->innerAdjacencies.data()+tb->innerAdjacencies.size())||(*innerAdjacency!=changes[k].first))
+                continue;
+            const double effortChange = (double)(field.effort(changes[k].first)-prevEffort(changes[k].second));
+            for (Eigen::SparseMatrix<double>::InnerIterator it(tb->cycles, innerAdjacency-tb->innerAdjacencies.data()); it; ++it)
+                cycleChanges.push_back(make_pair((int)it.row(), it.value()*effortChange));
+        }
+        sort(cycleChanges.begin(), cycleChanges.end());
+
+        //the index changes of the local cycles of every changed cycle
+        vector<pair<int, int>> localChanges;
+        for (int k=0;k<cycleChanges.size();){
+            const int cycle = cycleChanges[k].first;
+            double cycleChange = 0.0;
+            for (;(k<cycleChanges.size())&&(cycleChanges[k].first==cycle);k++)
+                cycleChange+=cycleChanges[k].second;
+            const int indexChange = std::round(cycleChange/(2.0*igl::PI));
+            if (indexChange!=0)
+                for (int j=tb->cycle2LocalOffsets(cycle);j<tb->cycle2LocalOffsets(cycle+1);j++)
+                    localChanges.push_back(make_pair(tb->cycle2Local(j), indexChange));
+        }
+        if (localChanges.empty())
+            return;
+        sort(localChanges.begin(), localChanges.end());
+
+        //merging with the (ascending) singularities
+        vector<int> singCyclesList;
+        vector<int> singIndicesList;
+        int j=0;
+        for (int i=0;(i<field.singLocalCycles.size())||(j<localChanges.size());){
+            int localCycle, index;
+            if ((j==localChanges.size())||((i<field.singLocalCycles.size())&&(field.singLocalCycles(i)<localChanges[j].first))){
+                localCycle=field.singLocalCycles(i);
+                index=field.singIndices(i++);
+            } else {
+                localCycle=localChanges[j].first;
+                index=localChanges[j++].second;
+                if ((i<field.singLocalCycles.size())&&(field.singLocalCycles(i)==localCycle))
+                    index+=field.singIndices(i++);
+            }
+            if (index!=0){
+                singCyclesList.push_back(localCycle);
+                singIndicesList.push_back(index);
+            }
+        }
+
+        field.set_singularities(Eigen::Map<Eigen::VectorXi>(singCyclesList.data(), singCyclesList.size()),
+                                Eigen::Map<Eigen::VectorXi>(singIndicesList.data(), singIndicesList.size()));
+    }
 }
 
 #endif
@@ -21,10 +21,11 @@ namespace directional
     //  isBoundaryVertex:   #V boolean indicating if vertex is a boundary.
     //output:
     //  G:                  #V discrete Gaussian curvature. sum(G) = eulerChar of mesh.
-    IGL_INLINE void gaussian_curvature(const Eigen::MatrixXd& V,
+    template<typename Scalar>
+    IGL_INLINE void gaussian_curvature(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& V,
                                        const Eigen::MatrixXi& F,
                                        const Eigen::VectorXi& isBoundaryVertex,
-                                       Eigen::VectorXd& G){
+                                       Eigen::Matrix<Scalar, Eigen::Dynamic, 1>& G){
 
         G.resize(V.rows());
         for (int i=0;i<V.rows();i++)
@@ -32,9 +33,9 @@ namespace directional
 
         for (int i=0;i<F.rows();i++) {
             for (int j = 0; j < 3; j++) {
-                Eigen::RowVector3d v1 = V.row(F(i, (j + 1) % 3)) - V.row(F(i, j));
-                Eigen::RowVector3d v2 = V.row(F(i, (j + 2) % 3)) - V.row(F(i, j));
-                double currAngle = std::acos(v1.dot(v2) / (v1.norm() * v2.norm()));
+                Eigen::Matrix<Scalar, 1, 3> v1 = V.row(F(i, (j + 1) % 3)) - V.row(F(i, j));
+                Eigen::Matrix<Scalar, 1, 3> v2 = V.row(F(i, (j + 2) % 3)) - V.row(F(i, j));
+                Scalar currAngle = std::acos(v1.dot(v2) / (v1.norm() * v2.norm()));
                 G(F(i, j)) -= currAngle;
             }
         }
@@ -28,16 +28,18 @@ namespace directional
   //  glyphColor: An array of either 1 by 3 color values for each vector, #F by 3 colors for each individual directional or #F*N by 3 colours for each individual vector, ordered by #F times vector 1, followed by #F times vector 2 etc.
   //  length, width,  height: of the glyphs depicting the directionals
   //  N:        The degree of the field.
+  //  The inputs can be of any scalar type (e.g., float fields for previews); the output mesh is always in double precision.
   
   // Outputs:
   //  fieldV: The vertices of the field mesh
   //  fieldF: The faces of the field mesh
   //  fieldC: The colors of the field mesh
   
-  void IGL_INLINE glyph_lines_mesh(const Eigen::MatrixXd& sources,
-                                   const Eigen::MatrixXd& normals,
+  template<typename Scalar>
+  void IGL_INLINE glyph_lines_mesh(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& sources,
+                                   const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& normals,
                                    const Eigen::MatrixXi& adjSpaces,
-                                   const Eigen::MatrixXd& extField,
+                                   const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& extField,
                                    const Eigen::MatrixXd& glyphColor,
                                    const double length,
                                    const double width,
@@ -118,9 +120,9 @@ namespace directional
     //normals.array() *= width;
     for (int i=0;i<sampledSpaces.size();i++)
       for (int j=0;j<N;j++){
-        P1.row(j*sampledSpaces.size()+i) = sources.row(sampledSpaces(i));
-        P2.row(j*sampledSpaces.size()+i) = extField.block(sampledSpaces(i),j*3,1,3);
-        vectNormals.row(j*sampledSpaces.size()+i) = normals.row(sampledSpaces(i)).array()*width;
+        P1.row(j*sampledSpaces.size()+i) = sources.row(sampledSpaces(i)).template cast<double>();
+        P2.row(j*sampledSpaces.size()+i) = extField.block(sampledSpaces(i),j*3,1,3).template cast<double>();
+        vectNormals.row(j*sampledSpaces.size()+i) = normals.row(sampledSpaces(i)).template cast<double>().array()*width;
       }
     
     /*P1 = barycenters.replicate(N, 1);
@@ -154,10 +156,11 @@ namespace directional
 
   
   //A version without specification of glyph dimensions
-  void IGL_INLINE glyph_lines_mesh(const Eigen::MatrixXd& sources,
-                                   const Eigen::MatrixXd& normals,
+  template<typename Scalar>
+  void IGL_INLINE glyph_lines_mesh(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& sources,
+                                   const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& normals,
                                    const Eigen::MatrixXi& adjSpaces,
-                                   const Eigen::MatrixXd& extField,
+                                   const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& extField,
                                    const Eigen::MatrixXd &glyphColors,
                                    const double sizeRatio,
                                    const double avgScale,
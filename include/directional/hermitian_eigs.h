@@ -0,0 +1,113 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2021 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DIRECTIONAL_HERMITIAN_EIGS_H
+#define DIRECTIONAL_HERMITIAN_EIGS_H
+
+#include <random>
+#include <algorithm>
+#include <igl/igl_inline.h>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <Eigen/Eigenvalues>
+
+
+namespace directional {
+
+  // Computes the smallest eigenpairs of the generalized Hermitian problem Q*u = s*M*u directly on the complex matrices (unlike complex_eigs(), which doubles them into real ones),
+  // by shift-invert subspace iteration with Rayleigh-Ritz projection. Q must be Hermitian positive semi-definite, and M Hermitian positive definite.
+  // Input:
+  //  Q:          #n by #n Hermitian matrix.
+  //  M:          #n by #n Hermitian mass matrix.
+  //  numEigs:    the number of (smallest) eigenpairs to compute.
+  //  tolerance:  residual |Q*u-s*M*u|, relative to the scale of Q and u, at which an eigenpair is considered converged.
+  //  maxIterations: the maximum number of subspace iterations.
+  // Output:
+  //  U:          #n by numEigs eigenvectors (M-orthonormal), by ascending eigenvalue.
+  //  S:          numEigs eigenvalues (real, stored as complex for compatibility with complex_eigs()).
+  //  returns true if all requested eigenpairs converged.
+  IGL_INLINE bool hermitian_eigs(const Eigen::SparseMatrix<std::complex<double>>& Q,
+                                 const Eigen::SparseMatrix<std::complex<double>>& M,
+                                 const int numEigs,
+                                 Eigen::MatrixXcd& U,
+                                 Eigen::VectorXcd& S,
+                                 const double tolerance = 1e-10,
+                                 const int maxIterations = 1000)
+  {
+    using namespace Eigen;
+    typedef std::complex<double> Complex;
+
+    const int n = Q.rows();
+    const int k = std::min(numEigs, n);
+    const int p = std::min(n, std::max(2*k, k+8));   //the size of the iterated subspace; the extra vectors speed up the convergence of the first k
+
+    //deterministic initial subspace
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> distribution(-1.0,1.0);
+    MatrixXcd X(n,p);
+    for (int i=0;i<n;i++)
+      for (int j=0;j<p;j++)
+        X(i,j)=Complex(distribution(generator), distribution(generator));
+
+    const double QScale = Q.cwiseAbs().sum()/(double)n;   //average absolute row sum
+    if (QScale==0.0){
+      //Q=0 (e.g., no inner edges): every vector is an eigenvector with eigenvalue 0, so any M-orthonormal basis is exact
+      MatrixXcd XM = X.leftCols(k);
+      LLT<MatrixXcd> gram((XM.adjoint()*(M*XM)+(M*XM).adjoint()*XM)/2.0);
+      if (gram.info()!=Success)
+        return false;
+      U = gram.matrixU().solve<OnTheRight>(XM);
+      S = VectorXcd::Zero(k);
+      return true;
+    }
+
+    //a small negative shift keeps Q-shift*M definite when Q is singular (e.g., for fields that can be perfectly parallel)
+    const double shift = -1e-8*(Q.cwiseAbs().sum()/M.cwiseAbs().sum());
+    SparseMatrix<Complex> A = Q - Complex(shift,0.0)*M;
+    SimplicialLDLT<SparseMatrix<Complex>> solver;
+    solver.compute(A);
+    if (solver.info()!=Success)
+      return false;
+
+    bool converged=false;
+    GeneralizedSelfAdjointEigenSolver<MatrixXcd> ritzSolver;
+    for (int iteration=0; (iteration<maxIterations) && (!converged); iteration++){
+      MatrixXcd Y = solver.solve(M*X);
+
+      //Rayleigh-Ritz on the new subspace
+      MatrixXcd QY = Q*Y;
+      MatrixXcd MY = M*Y;
+      MatrixXcd QReduced = Y.adjoint()*QY;
+      MatrixXcd MReduced = Y.adjoint()*MY;
+      QReduced = (QReduced+QReduced.adjoint())/2.0;
+      MReduced = (MReduced+MReduced.adjoint())/2.0;
+      ritzSolver.compute(QReduced, MReduced);
+      if (ritzSolver.info()!=Success)
+        return false;
+
+      X = Y*ritzSolver.eigenvectors();
+      QY = QY*ritzSolver.eigenvectors();
+      MY = MY*ritzSolver.eigenvectors();
+
+      converged=true;
+      for (int j=0;j<k;j++){
+        double residual = (QY.col(j)-ritzSolver.eigenvalues()(j)*MY.col(j)).norm();
+        if (residual>tolerance*QScale*X.col(j).norm())
+          converged=false;
+      }
+    }
+
+    U = X.leftCols(k);
+    S = ritzSolver.eigenvalues().head(k).cast<Complex>();
+    return converged;
+  }
+
+}
+
+
+#endif
@@ -11,13 +11,48 @@
 #include <Eigen/Core>
 #include <vector>
 #include <cmath>
+#include <limits>
+#include <thread>
+#include <algorithm>
 #include <igl/igl_inline.h>
+#include <igl/parallel_for.h>
 #include <directional/CartesianField.h>
 #include <directional/rotation_to_raw.h>
+#include <directional/conjugate_gradient.h>
 
 
 namespace directional
 {
+    // The factorization of the cycle Laplacian cycles*cycles^T of a tangent bundle, kept alongside the bundle for index_prescription() over many index configurations.
+    // It is computed on the first solve, and recomputed only if the solver is used with another bundle or the cycles of the bundle changed.
+    struct IndexPrescriptionSolver{
+    public:
+
+        const TangentBundle* tb;                                        // the bundle of the current factorization (NULL if none)
+        Eigen::SparseMatrix<double> cycles;                             // the cycles of tb when it was factorized
+        Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> ldltSolver;  // the factorization of cycles*cycles^T
+
+        IndexPrescriptionSolver():tb(NULL){}
+        IndexPrescriptionSolver(const TangentBundle& _tb):tb(NULL){ init(_tb); }
+        IndexPrescriptionSolver(const IndexPrescriptionSolver&):tb(NULL){}
+        IndexPrescriptionSolver& operator=(const IndexPrescriptionSolver&){ tb=NULL; return *this; }
+        ~IndexPrescriptionSolver(){}
+
+        //makes the solver hold the factorization of the cycle Laplacian of _tb, unless it already does
+        void init(const TangentBundle& _tb){
+            if ((tb==&_tb) && (_tb.cycles.rows()==cycles.rows()) && (_tb.cycles.cols()==cycles.cols()) && (_tb.cycles.nonZeros()==cycles.nonZeros()) && _tb.cycles.isCompressed() &&
+                std::equal(_tb.cycles.outerIndexPtr(), _tb.cycles.outerIndexPtr()+_tb.cycles.outerSize()+1, cycles.outerIndexPtr()) &&
+                std::equal(_tb.cycles.innerIndexPtr(), _tb.cycles.innerIndexPtr()+_tb.cycles.nonZeros(), cycles.innerIndexPtr()) &&
+                std::equal(_tb.cycles.valuePtr(), _tb.cycles.valuePtr()+_tb.cycles.nonZeros(), cycles.valuePtr()))
+                return;
+            tb = &_tb;
+            cycles = _tb.cycles;
+            cycles.makeCompressed();
+            ldltSolver.compute(cycles*cycles.transpose());
+            assert(ldltSolver.info() == Eigen::Success && "IndexPrescriptionSolver: factorization failed");
+        }
+    };
+
     // Computes the rotation angles that are required to reproduce a prescribed set of indices on the dual cycles of the mesh.
     // In case the sum of curvature is not consistent with the topology, the system is solved in least squares and unexpected singularities may appear elsewhere. linfError will mostl like be far from zero.
     // Input:
@@ -60,6 +95,80 @@ namespace directional
         directional::rotation_to_raw(*(field.tb), rotationAngles,N,globalRotation,field);
     }
 
+    // Batched version with a persistent solver: the indices of all configurations are solved as a block with the cached factorization (the columns split between
+    // the threads), and the fields are then constructed in parallel.
+    // Input:
+    //  cycleIndicesBatch:  the prescribed cycle indices of each configuration.
+    //  N, globalRotation:  as above, shared by all configurations.
+    //  tb:                 the tangent bundle of the fields.
+    //  solver:             the persistent solver, (re)initialized for tb if needed.
+    //  parallel:           whether to solve and construct the configurations in parallel.
+    // Output:
+    //  fields:             the raw field of each configuration.
+    //  rotationAngles:     the rotation angles of each configuration.
+    //  linfErrors:         the l_infinity error of each configuration.
+    IGL_INLINE void index_prescription(const std::vector<Eigen::VectorXi>& cycleIndicesBatch,
+                                       const int N,
+                                       const double globalRotation,
+                                       const TangentBundle& tb,
+                                       IndexPrescriptionSolver& solver,
+                                       std::vector<directional::CartesianField>& fields,
+                                       std::vector<Eigen::VectorXd>& rotationAngles,
+                                       Eigen::VectorXd& linfErrors,
+                                       const bool parallel = true)
+    {
+        using namespace Eigen;
+        using namespace std;
+
+        const int numConfigs = cycleIndicesBatch.size();
+        const size_t minParallel = (parallel ? 1 : std::numeric_limits<size_t>::max());
+        solver.init(tb);
+        fields.resize(numConfigs);
+        rotationAngles.resize(numConfigs);
+        linfErrors.resize(numConfigs);
+        if (numConfigs==0)
+            return;
+
+        MatrixXd cycleRhs(tb.cycles.rows(), numConfigs);
+        for (int c=0;c<numConfigs;c++)
+            cycleRhs.col(c) = -tb.cycleCurvatures + cycleIndicesBatch[c].cast<double>()*(2.0*igl::PI/(double)N);
+
+        const int numChunks = (parallel ? std::max(1, std::min(numConfigs, (int)std::thread::hardware_concurrency())) : 1);
+        MatrixXd innerRotationAngles(tb.cycles.cols(), numConfigs);
+        igl::parallel_for(numChunks, [&](const int chunk){
+            const int begin = (chunk*numConfigs)/numChunks;
+            const int end = ((chunk+1)*numConfigs)/numChunks;
+            innerRotationAngles.middleCols(begin, end-begin) = tb.cycles.transpose()*solver.ldltSolver.solve(cycleRhs.middleCols(begin, end-begin));
+        }, minParallel);
+
+        igl::parallel_for(numConfigs, [&](const int c){
+            rotationAngles[c] = VectorXd::Zero(tb.adjSpaces.rows());
+            for (int i=0;i<tb.innerAdjacencies.rows();i++)
+                rotationAngles[c](tb.innerAdjacencies(i))=innerRotationAngles(i,c);
+
+            linfErrors(c) = (tb.cycles*innerRotationAngles.col(c) - cycleRhs.col(c)).template lpNorm<Infinity>();
+            directional::rotation_to_raw(tb, rotationAngles[c], N, globalRotation, fields[c]);
+        }, minParallel);
+    }
+
+    //Single-configuration version with a persistent solver
+    IGL_INLINE void index_prescription(const Eigen::VectorXi& cycleIndices,
+                                       const int N,
+                                       const double globalRotation,
+                                       IndexPrescriptionSolver& solver,
+                                       directional::CartesianField& field,
+                                       Eigen::VectorXd& rotationAngles,
+                                       double &linfError)
+    {
+        std::vector<directional::CartesianField> fields;
+        std::vector<Eigen::VectorXd> rotationAnglesBatch;
+        Eigen::VectorXd linfErrors;
+        index_prescription(std::vector<Eigen::VectorXi>(1, cycleIndices), N, globalRotation, *(field.tb), solver, fields, rotationAnglesBatch, linfErrors);
+        field = fields[0];
+        rotationAngles = rotationAnglesBatch[0];
+        linfError = linfErrors(0);
+    }
+
     //Minimal version: without a provided solver
     IGL_INLINE void index_prescription(const Eigen::VectorXi& cycleIndices,
                                        const int N,
@@ -71,6 +180,47 @@ namespace directional
         Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > ldltSolver;
         index_prescription(cycleIndices, N, globalRotation,ldltSolver,  field, rotationAngles, error);
     }
+
+    //Iterative version, for meshes on which the factorizations do not fit in memory: the same system cycles*cycles^T*y=rhs as the factorized version is solved matrix-free
+    //by Jacobi-preconditioned conjugate gradient with the given relative tolerance (cycles*cycles^T is never formed), and the rotation angles are the minimal-norm cycles^T*y.
+    //The prescribed indices must be consistent with the topology for the solver to converge (which is asserted). rotation_to_raw() then propagates
+    //the field along a spanning tree, and is only solved (iteratively) if the angles are not consistent.
+    IGL_INLINE void index_prescription(const Eigen::VectorXi& cycleIndices,
+                                       const int N,
+                                       const double globalRotation,
+                                       const double iterativeTolerance,
+                                       directional::CartesianField& field,
+                                       Eigen::VectorXd& rotationAngles,
+                                       double &linfError)
+    {
+        using namespace Eigen;
+        using namespace std;
+
+        const SparseMatrix<double>& cycles = field.tb->cycles;
+        VectorXd cycleNewCurvature = cycleIndices.cast<double>()*(2.0*igl::PI/(double)N);
+
+        //the diagonal of cycles*cycles^T are the squared norms of the cycles
+        VectorXd jacobiDiagonal = cycles.cwiseAbs2()*VectorXd::Ones(cycles.cols());
+        for (int i=0;i<jacobiDiagonal.size();i++)
+            if (jacobiDiagonal(i)==0.0)
+                jacobiDiagonal(i)=1.0;
+
+        auto applyLhs = [&](const VectorXd& y, VectorXd& z){ z = cycles*VectorXd(cycles.transpose()*y); };
+        auto applyPrecond = [&](const VectorXd& r, VectorXd& z){ z = r.cwiseQuotient(jacobiDiagonal); };
+        VectorXd cycleLagrangeMultipliers;
+        bool converged = conjugate_gradient(applyLhs, applyPrecond, VectorXd(-field.tb->cycleCurvatures + cycleNewCurvature), cycleLagrangeMultipliers, iterativeTolerance, 100*cycles.rows());
+        assert(converged && "index_prescription(): conjugate gradient did not converge (are the indices consistent?)");
+        VectorXd innerRotationAngles = cycles.transpose()*cycleLagrangeMultipliers;
+
+        rotationAngles.conservativeResize(field.tb->adjSpaces.rows());
+        rotationAngles.setZero();
+        for (int i=0;i<field.tb->innerAdjacencies.rows();i++)
+            rotationAngles(field.tb->innerAdjacencies(i))=innerRotationAngles(i);
+
+        linfError = (cycles*innerRotationAngles - (-field.tb->cycleCurvatures + cycleNewCurvature)).template lpNorm<Infinity>();
+
+        directional::rotation_to_raw(*(field.tb), rotationAngles,N,globalRotation,field,true,iterativeTolerance);
+    }
 }
 
 
@@ -0,0 +1,105 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2022 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_MAPPED_FILE_H
+#define DIRECTIONAL_MAPPED_FILE_H
+#include <string>
+#include <vector>
+#include <fstream>
+#include <igl/igl_inline.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace directional{
+
+    //Read-only view of the entire contents of a file, either memory-mapped (POSIX), or, when mapping is unavailable or not requested, loaded with a single bulk read.
+    //The contents are at [data, data+size), and are not null-terminated.
+    class MappedFile{
+    public:
+        const char* data;
+        size_t size;
+
+        MappedFile():data(NULL), size(0), loaded(false){
+#ifndef _WIN32
+            mapped=NULL;
+#endif
+        }
+
+        ~MappedFile(){ close(); }
+
+        //Owns the mapping (or buffer) that data points into, so it is not copyable.
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        //Returns whether the file could be opened and read. Empty files are loaded with size 0.
+        bool IGL_INLINE open(const std::string& fileName, const bool useMmap=true){
+            close();
+#ifndef _WIN32
+            if (useMmap){
+                int fd = ::open(fileName.c_str(), O_RDONLY);
+                if (fd<0)
+                    return false;
+                struct stat st;
+                if ((fstat(fd, &st)==0)&&(st.st_size>0)){
+                    void* ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (ptr!=MAP_FAILED){
+                        madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+                        mapped=ptr;
+                        data=(const char*)ptr;
+                        size=st.st_size;
+                        loaded=true;
+                    }
+                }
+                ::close(fd);
+                if (loaded)
+                    return true;
+            }
+#endif
+            std::ifstream f(fileName, std::ios::binary | std::ios::ate);
+            if (!f.is_open())
+                return false;
+            std::streamsize fileSize = f.tellg();
+            if (fileSize<0)
+                return false;
+            buffer.resize(fileSize);
+            f.seekg(0, std::ios::beg);
+            if ((fileSize>0)&&(!f.read(buffer.data(), fileSize)))
+                return false;
+            data=buffer.data();
+            size=buffer.size();
+            loaded=true;
+            return true;
+        }
+
+        void IGL_INLINE close(){
+#ifndef _WIN32
+            if (mapped!=NULL)
+                munmap(mapped, size);
+            mapped=NULL;
+#endif
+            std::vector<char>().swap(buffer);
+            data=NULL;
+            size=0;
+            loaded=false;
+        }
+
+        bool is_open() const { return loaded; }
+
+    private:
+        bool loaded;
+        std::vector<char> buffer;  //Used when the file is not mapped
+#ifndef _WIN32
+        void* mapped;
+#endif
+    };
+}
+
+#endif
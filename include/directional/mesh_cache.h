@@ -0,0 +1,346 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2022 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_MESH_CACHE_H
+#define DIRECTIONAL_MESH_CACHE_H
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <directional/TriMesh.h>
+#include <directional/TangentBundle.h>
+#include <directional/mapped_file.h>
+
+/***
+ Binary cache of a fully-built TriMesh and its tangent bundle (see write_mesh_cache.h and read_mesh_cache.h).
+ The file is a fixed header (magic, format version, endianness tag, bundle type) followed by the raw data of every array, in a fixed order.
+ Each dense array is stored as (int64 rows, int64 cols, column-major data), and each sparse matrix in compressed form (int64 rows, cols, nonzeros, outer indices, inner indices, values).
+ The format is native to the writing machine (endianness, sizeof(int)); a cache that does not match is rejected, and should just be rebuilt from the mesh.
+***/
+
+namespace directional{
+
+    const char meshCacheMagic[8] = {'D','I','R','C','A','C','H','E'};
+    const std::uint32_t meshCacheVersion = 3;      //Increment whenever the layout of the cache changes
+    const std::uint32_t meshCacheEndianTag = 0x01020304;
+
+    //Sequential writer of the cache contents
+    class MeshCacheWriter{
+    public:
+        std::ofstream f;
+
+        MeshCacheWriter(const std::string& fileName):f(fileName, std::ios::binary | std::ios::trunc){}
+
+        void write_raw(const void* data, const size_t numBytes){
+            if (numBytes>0)
+                f.write((const char*)data, numBytes);
+        }
+
+        template<typename T>
+        void write_scalar(const T& value){ write_raw(&value, sizeof(T)); }
+
+        template<typename Derived>
+        void write_matrix(const Eigen::PlainObjectBase<Derived>& M){
+            write_scalar<std::int64_t>(M.rows());
+            write_scalar<std::int64_t>(M.cols());
+            write_raw(M.data(), sizeof(typename Derived::Scalar)*M.size());
+        }
+
+        void write_sparse(const Eigen::SparseMatrix<double>& _M){
+            Eigen::SparseMatrix<double> M = _M;
+            M.makeCompressed();
+            write_scalar<std::int64_t>(M.rows());
+            write_scalar<std::int64_t>(M.cols());
+            write_scalar<std::int64_t>(M.nonZeros());
+            write_raw(M.outerIndexPtr(), sizeof(int)*(M.outerSize()+1));
+            write_raw(M.innerIndexPtr(), sizeof(int)*M.nonZeros());
+            write_raw(M.valuePtr(), sizeof(double)*M.nonZeros());
+        }
+
+        void write_header(const discTangTypeEnum tangType){
+            write_raw(meshCacheMagic, sizeof(meshCacheMagic));
+            write_scalar<std::uint32_t>(meshCacheVersion);
+            write_scalar<std::uint32_t>(meshCacheEndianTag);
+            write_scalar<std::uint32_t>(sizeof(int));
+            write_scalar<std::int32_t>((std::int32_t)tangType);
+        }
+
+        void write_mesh(const TriMesh& mesh){
+            write_matrix(mesh.V);
+            write_matrix(mesh.F);
+            write_matrix(mesh.vertexOrder);
+            write_matrix(mesh.faceOrder);
+            write_matrix(mesh.edgeOrder);
+            write_matrix(mesh.edgeOrientation);
+            write_scalar<std::int32_t>((std::int32_t)mesh.elementOrder);
+            write_matrix(mesh.EF);
+            write_matrix(mesh.FE);
+            write_matrix(mesh.EV);
+            write_matrix(mesh.TT);
+            write_matrix(mesh.EFi);
+            write_matrix(mesh.FEs);
+            write_matrix(mesh.innerEdges);
+            write_matrix(mesh.boundEdges);
+            write_matrix(mesh.vertexValence);
+            write_matrix(mesh.isBoundaryVertex);
+            write_matrix(mesh.isBoundaryEdge);
+            write_matrix(mesh.vertexOneRingOffsets);
+            write_matrix(mesh.vertexOneRingEdges);
+            write_matrix(mesh.vertexOneRingFaces);
+            write_matrix(mesh.VH);
+            write_matrix(mesh.HV);
+            write_matrix(mesh.HE);
+            write_matrix(mesh.HF);
+            write_matrix(mesh.nextH);
+            write_matrix(mesh.prevH);
+            write_matrix(mesh.twinH);
+            write_matrix(mesh.EH);
+            write_matrix(mesh.FH);
+            write_matrix(mesh.faceNormals);
+            write_matrix(mesh.faceAreas);
+            write_matrix(mesh.vertexNormals);
+            write_matrix(mesh.FBx);
+            write_matrix(mesh.FBy);
+            write_matrix(mesh.VBx);
+            write_matrix(mesh.VBy);
+            write_matrix(mesh.barycenters);
+            write_matrix(mesh.GaussianCurvature);
+            write_scalar<double>(mesh.avgEdgeLength);
+            write_matrix(mesh.minBox);
+            write_matrix(mesh.maxBox);
+            write_scalar<std::int32_t>(mesh.eulerChar);
+            write_scalar<std::int32_t>(mesh.numGenerators);
+            write_scalar<std::int64_t>(mesh.boundaryLoops.size());
+            for (int i=0;i<mesh.boundaryLoops.size();i++){
+                write_scalar<std::int64_t>(mesh.boundaryLoops[i].size());
+                write_raw(mesh.boundaryLoops[i].data(), sizeof(int)*mesh.boundaryLoops[i].size());
+            }
+        }
+
+        //The members of the TangentBundle base class; derived bundles append their own members after these.
+        void write_bundle(const TangentBundle& tb){
+            write_scalar<std::int32_t>(tb.intDimension);
+            write_matrix(tb.adjSpaces);
+            write_matrix(tb.oneRing);
+            write_matrix(tb.oneRingOffsets);
+            write_matrix(tb.oneRingAdjacencies);
+            write_matrix(tb.innerAdjacencies);
+            write_sparse(tb.cycles);
+            write_matrix(tb.cycleCurvatures);
+            write_matrix(tb.local2Cycle);
+            write_matrix(tb.connection);
+            write_matrix(tb.connectionMass);
+            write_matrix(tb.tangentSpaceMass);
+            write_matrix(tb.sources);
+            write_matrix(tb.normals);
+            write_matrix(tb.cycleSources);
+            write_matrix(tb.cycleNormals);
+        }
+    };
+
+    //Sequential reader of the cache contents, from a memory-mapped file or (when mapping is unavailable or not requested) a single bulk read of the file.
+    //Every read is a bounds-checked memcpy; once a read fails, all subsequent reads fail and good() returns false.
+    class MeshCacheReader{
+    public:
+        MappedFile file;
+        const char* data;
+        size_t size;
+        size_t offset;
+        bool valid;
+
+        MeshCacheReader(const std::string& fileName, const bool useMmap):offset(0){
+            valid = file.open(fileName, useMmap);
+            data = file.data;
+            size = file.size;
+        }
+
+        //data points into file, so the reader is not copyable.
+        MeshCacheReader(const MeshCacheReader&) = delete;
+        MeshCacheReader& operator=(const MeshCacheReader&) = delete;
+
+        bool good() const { return valid; }
+
+        void read_raw(void* dest, const size_t numBytes){
+            if ((!valid)||(numBytes>size-offset)){
+                valid=false;
+                return;
+            }
+            if (numBytes>0)
+                std::memcpy(dest, data+offset, numBytes);
+            offset+=numBytes;
+        }
+
+        template<typename T>
+        T read_scalar(){
+            T value = T();
+            read_raw(&value, sizeof(T));
+            return value;
+        }
+
+        template<typename Derived>
+        void read_matrix(Eigen::PlainObjectBase<Derived>& M){
+            std::int64_t rows = read_scalar<std::int64_t>();
+            std::int64_t cols = read_scalar<std::int64_t>();
+            if ((!valid)||(rows<0)||(cols<0)||
+                ((Derived::RowsAtCompileTime!=Eigen::Dynamic)&&(rows!=Derived::RowsAtCompileTime))||
+                ((Derived::ColsAtCompileTime!=Eigen::Dynamic)&&(cols!=Derived::ColsAtCompileTime))||
+                ((cols>0)&&((size_t)rows>(size-offset)/sizeof(typename Derived::Scalar)/cols))){
+                valid=false;
+                return;
+            }
+            M.resize(rows, cols);
+            read_raw(M.data(), sizeof(typename Derived::Scalar)*M.size());
+        }
+
+        void read_sparse(Eigen::SparseMatrix<double>& M){
+            std::int64_t rows = read_scalar<std::int64_t>();
+            std::int64_t cols = read_scalar<std::int64_t>();
+            std::int64_t nnz = read_scalar<std::int64_t>();
+            if ((!valid)||(rows<0)||(cols<0)||(nnz<0)||
+                (rows>std::numeric_limits<int>::max())||(cols>std::numeric_limits<int>::max())||(nnz>std::numeric_limits<int>::max())||
+                ((size_t)nnz>(size-offset)/sizeof(double))){
+                valid=false;
+                return;
+            }
+            M.resize(rows, cols);
+            M.resizeNonZeros(nnz);
+            read_raw(M.outerIndexPtr(), sizeof(int)*(M.outerSize()+1));
+            read_raw(M.innerIndexPtr(), sizeof(int)*nnz);
+            read_raw(M.valuePtr(), sizeof(double)*nnz);
+            if (!valid)
+                return;
+
+            //the indices must describe a compressed matrix (non-decreasing outer indices from 0 to nnz, and sorted inner indices within [0, rows) per column)
+            const int* outer = M.outerIndexPtr();
+            const int* inner = M.innerIndexPtr();
+            bool indicesValid = (outer[0]==0)&&(outer[M.outerSize()]==nnz);
+            for (int i=0;(i<M.outerSize())&&indicesValid;i++){
+                if ((outer[i]>outer[i+1])||(outer[i+1]>nnz)){
+                    indicesValid=false;
+                    break;
+                }
+                for (int j=outer[i];j<outer[i+1];j++)
+                    if ((inner[j]<0)||(inner[j]>=rows)||((j>outer[i])&&(inner[j]<=inner[j-1]))){
+                        indicesValid=false;
+                        break;
+                    }
+            }
+            if (!indicesValid){
+                M.resize(0,0);
+                valid=false;
+            }
+        }
+
+        bool read_header(const discTangTypeEnum tangType){
+            char magic[8];
+            read_raw(magic, sizeof(magic));
+            if ((!valid)||(std::memcmp(magic, meshCacheMagic, sizeof(magic))!=0))
+                return valid=false;
+            if ((read_scalar<std::uint32_t>()!=meshCacheVersion)||
+                (read_scalar<std::uint32_t>()!=meshCacheEndianTag)||
+                (read_scalar<std::uint32_t>()!=sizeof(int))||
+                (read_scalar<std::int32_t>()!=(std::int32_t)tangType))
+                valid=false;
+            return valid;
+        }
+
+        void read_mesh(TriMesh& mesh){
+            read_matrix(mesh.V);
+            read_matrix(mesh.F);
+            read_matrix(mesh.vertexOrder);
+            read_matrix(mesh.faceOrder);
+            read_matrix(mesh.edgeOrder);
+            read_matrix(mesh.edgeOrientation);
+            mesh.elementOrder = (elementOrderTypeEnum)read_scalar<std::int32_t>();
+            read_matrix(mesh.EF);
+            read_matrix(mesh.FE);
+            read_matrix(mesh.EV);
+            read_matrix(mesh.TT);
+            read_matrix(mesh.EFi);
+            read_matrix(mesh.FEs);
+            read_matrix(mesh.innerEdges);
+            read_matrix(mesh.boundEdges);
+            read_matrix(mesh.vertexValence);
+            read_matrix(mesh.isBoundaryVertex);
+            read_matrix(mesh.isBoundaryEdge);
+            read_matrix(mesh.vertexOneRingOffsets);
+            read_matrix(mesh.vertexOneRingEdges);
+            read_matrix(mesh.vertexOneRingFaces);
+            read_matrix(mesh.VH);
+            read_matrix(mesh.HV);
+            read_matrix(mesh.HE);
+            read_matrix(mesh.HF);
+            read_matrix(mesh.nextH);
+            read_matrix(mesh.prevH);
+            read_matrix(mesh.twinH);
+            read_matrix(mesh.EH);
+            read_matrix(mesh.FH);
+            read_matrix(mesh.faceNormals);
+            read_matrix(mesh.faceAreas);
+            read_matrix(mesh.vertexNormals);
+            read_matrix(mesh.FBx);
+            read_matrix(mesh.FBy);
+            read_matrix(mesh.VBx);
+            read_matrix(mesh.VBy);
+            read_matrix(mesh.barycenters);
+            read_matrix(mesh.GaussianCurvature);
+            mesh.avgEdgeLength = read_scalar<double>();
+            read_matrix(mesh.minBox);
+            read_matrix(mesh.maxBox);
+            mesh.eulerChar = read_scalar<std::int32_t>();
+            mesh.numGenerators = read_scalar<std::int32_t>();
+            std::int64_t numLoops = read_scalar<std::int64_t>();
+            if ((!valid)||(numLoops<0)||((size_t)numLoops>(size-offset)/sizeof(std::int64_t))){
+                valid=false;
+                return;
+            }
+            mesh.boundaryLoops.resize(numLoops);
+            for (int i=0;i<numLoops;i++){
+                std::int64_t loopSize = read_scalar<std::int64_t>();
+                if ((!valid)||(loopSize<0)||((size_t)loopSize>(size-offset)/sizeof(int))){
+                    valid=false;
+                    return;
+                }
+                mesh.boundaryLoops[i].resize(loopSize);
+                read_raw(mesh.boundaryLoops[i].data(), sizeof(int)*loopSize);
+            }
+            //update_geometry() permutes new positions by vertexOrder
+            if (valid && (mesh.vertexOrder.size()!=mesh.V.rows() || (mesh.V.rows()>0 && (mesh.vertexOrder.minCoeff()<0 || mesh.vertexOrder.maxCoeff()>=mesh.V.rows()))))
+                valid=false;
+            if (valid)
+                mesh.update_is_reordered();
+            if (valid && mesh.denseOneRings)
+                mesh.compute_dense_one_rings();
+        }
+
+        void read_bundle(TangentBundle& tb){
+            tb.intDimension = read_scalar<std::int32_t>();
+            read_matrix(tb.adjSpaces);
+            read_matrix(tb.oneRing);
+            read_matrix(tb.oneRingOffsets);
+            read_matrix(tb.oneRingAdjacencies);
+            read_matrix(tb.innerAdjacencies);
+            read_sparse(tb.cycles);
+            read_matrix(tb.cycleCurvatures);
+            read_matrix(tb.local2Cycle);
+            read_matrix(tb.connection);
+            read_matrix(tb.connectionMass);
+            read_matrix(tb.tangentSpaceMass);
+            read_matrix(tb.sources);
+            read_matrix(tb.normals);
+            read_matrix(tb.cycleSources);
+            read_matrix(tb.cycleNormals);
+            if (valid)
+                tb.update_cycle_to_local();
+        }
+    };
+}
+
+#endif
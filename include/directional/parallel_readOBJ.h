@@ -0,0 +1,145 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2022 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_PARALLEL_READ_OBJ_H
+#define DIRECTIONAL_PARALLEL_READ_OBJ_H
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+#include <igl/parallel_for.h>
+#include <directional/TriMesh.h>
+#include <directional/mapped_file.h>
+#include <directional/parse_mesh_text.h>
+
+namespace directional
+{
+    //Whether the line (already space-skipped) begins with the given OBJ keyword
+    inline bool is_obj_keyword(const char* p, const char* end, const char keyword){
+        return ((end-p>=2)&&(p[0]==keyword)&&(is_text_space(p[1])));
+    }
+
+    // Reads a mesh from an OBJ file. The file is mapped and split into chunks of lines that are parsed in parallel directly into V and F, without
+    // intermediate per-element containers. Only "v" and "f" lines are read (texture coordinates, normals, groups and materials are ignored),
+    // and polygonal faces are fan-triangulated. Face corners may be of the form i, i/t, i//n or i/t/n, with negative (relative) indices.
+    // Inputs:
+    //   fileName: The to be loaded file.
+    //   useMmap: read the file through a memory map (POSIX only; otherwise the file is read with a single bulk read).
+    // Outputs:
+    //   V: #V x 3 vertex coordinates.
+    //   F: #F x 3 triangles.
+    // Return:
+    //   Whether or not the file was read successfully
+    bool IGL_INLINE parallel_readOBJ(const std::string& fileName,
+                                     Eigen::MatrixXd& V,
+                                     Eigen::MatrixXi& F,
+                                     const bool useMmap=true)
+    {
+        MappedFile file;
+        if (!file.open(fileName, useMmap))
+            return false;
+
+        std::vector<const char*> chunkStarts;
+        split_text_chunks(file.data, file.data+file.size, textChunkSize, chunkStarts);
+        const int numChunks = chunkStarts.size()-1;
+
+        //First pass: counting vertices and triangles in each chunk
+        std::vector<long> vertexStarts(numChunks+1,0), triangleStarts(numChunks+1,0);
+        igl::parallel_for(numChunks, [&](const int c){
+            const char* chunkEnd = chunkStarts[c+1];
+            for (const char* q=chunkStarts[c];q<chunkEnd;q=next_text_line(q, chunkEnd)){
+                q = skip_text_spaces(q, chunkEnd);
+                if (is_obj_keyword(q, chunkEnd, 'v'))
+                    vertexStarts[c+1]++;
+                else if (is_obj_keyword(q, chunkEnd, 'f')){
+                    long numCorners=0;
+                    q = skip_text_spaces(q+1, chunkEnd);
+                    while ((q<chunkEnd)&&(*q!='\n')&&(*q!='#')){
+                        numCorners++;
+                        while ((q<chunkEnd)&&(!is_text_space(*q))&&(*q!='\n'))
+                            q++;
+                        q = skip_text_spaces(q, chunkEnd);
+                    }
+                    if (numCorners>=3)
+                        triangleStarts[c+1]+=numCorners-2;
+                }
+            }
+        }, 2);
+        for (int c=0;c<numChunks;c++){
+            vertexStarts[c+1]+=vertexStarts[c];
+            triangleStarts[c+1]+=triangleStarts[c];
+        }
+        const long numV = vertexStarts[numChunks];
+
+        //Second pass: parsing
+        V.resize(numV,3);
+        F.resize(triangleStarts[numChunks],3);
+        std::vector<char> chunkValid(numChunks,1);
+        igl::parallel_for(numChunks, [&](const int c){
+            long currVertex=vertexStarts[c];
+            long currTriangle=triangleStarts[c];
+            const char* chunkEnd = chunkStarts[c+1];
+            for (const char* q=chunkStarts[c];q<chunkEnd;q=next_text_line(q, chunkEnd)){
+                q = skip_text_spaces(q, chunkEnd);
+                if (is_obj_keyword(q, chunkEnd, 'v')){
+                    q++;
+                    for (int j=0;j<3;j++)
+                        if (!parse_text_double(q, chunkEnd, V(currVertex,j)))
+                            chunkValid[c]=0;
+                    currVertex++;
+                } else if (is_obj_keyword(q, chunkEnd, 'f')){
+                    long numCorners=0, first=0, prev=0, curr;
+                    q = skip_text_spaces(q+1, chunkEnd);
+                    while ((q<chunkEnd)&&(*q!='\n')&&(*q!='#')){
+                        //relative indices refer to the vertices read so far
+                        if ((!parse_text_int(q, chunkEnd, curr))||(curr==0)){
+                            chunkValid[c]=0;
+                            return;
+                        }
+                        curr = (curr<0 ? currVertex+curr : curr-1);
+                        if ((curr<0)||(curr>=numV)){
+                            chunkValid[c]=0;
+                            return;
+                        }
+                        if (numCorners==0)
+                            first=curr;
+                        if (numCorners>=2){
+                            F(currTriangle,0)=first;
+                            F(currTriangle,1)=prev;
+                            F(currTriangle,2)=curr;
+                            currTriangle++;
+                        }
+                        prev=curr;
+                        numCorners++;
+                        while ((q<chunkEnd)&&(!is_text_space(*q))&&(*q!='\n'))  //skipping texture and normal indices
+                            q++;
+                        q = skip_text_spaces(q, chunkEnd);
+                    }
+                    if (numCorners<3)
+                        chunkValid[c]=0;
+                }
+            }
+        }, 2);
+        for (int c=0;c<numChunks;c++)
+            if (!chunkValid[c])
+                return false;
+
+        return true;
+    }
+
+    // Reads an OBJ file with parallel_readOBJ() into a mesh object.
+    bool IGL_INLINE parallel_readOBJ(const std::string& fileName,
+                                     directional::TriMesh& mesh,
+                                     const bool useMmap=true){
+        Eigen::MatrixXd V;
+        Eigen::MatrixXi F;
+        if (!parallel_readOBJ(fileName,V,F,useMmap))
+            return false;
+        mesh.set_mesh(V,F);
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,163 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2022 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_PARALLEL_READ_OFF_H
+#define DIRECTIONAL_PARALLEL_READ_OFF_H
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+#include <igl/parallel_for.h>
+#include <directional/TriMesh.h>
+#include <directional/mapped_file.h>
+#include <directional/parse_mesh_text.h>
+
+namespace directional
+{
+    // Reads a mesh from an OFF file. The file is mapped and split into chunks of lines that are parsed in parallel directly into V and F, without
+    // intermediate per-element containers. Polygonal faces are fan-triangulated; colors, normals and other per-element data are ignored.
+    // Inputs:
+    //   fileName: The to be loaded file.
+    //   useMmap: read the file through a memory map (POSIX only; otherwise the file is read with a single bulk read).
+    // Outputs:
+    //   V: #V x 3 vertex coordinates.
+    //   F: #F x 3 triangles.
+    // Return:
+    //   Whether or not the file was read successfully
+    bool IGL_INLINE parallel_readOFF(const std::string& fileName,
+                                     Eigen::MatrixXd& V,
+                                     Eigen::MatrixXi& F,
+                                     const bool useMmap=true)
+    {
+        MappedFile file;
+        if (!file.open(fileName, useMmap))
+            return false;
+        const char* p = file.data;
+        const char* end = file.data+file.size;
+
+        //header: [C][N][4]OFF, possibly followed by the counts on the same line
+        p = skip_text_spaces(p, end);
+        while ((p<end)&&(is_text_blank(p, end))){
+            p = skip_text_spaces(next_text_line(p, end), end);
+            if (p==end)
+                return false;
+        }
+        const char* keyword = p;
+        while ((p<end)&&(!is_text_space(*p))&&(*p!='\n'))
+            p++;
+        if ((p-keyword<3)||(std::string(p-3, p)!="OFF"))
+            return false;
+        p = skip_text_spaces(p, end);
+        while ((p<end)&&(is_text_blank(p, end))){
+            p = skip_text_spaces(next_text_line(p, end), end);
+            if (p==end)
+                return false;
+        }
+        long numV, numF;
+        if ((!parse_text_int(p, end, numV))||(!parse_text_int(p, end, numF))||(numV<0)||(numF<0))
+            return false;
+        const char* body = next_text_line(p, end);
+
+        std::vector<const char*> chunkStarts;
+        split_text_chunks(body, end, textChunkSize, chunkStarts);
+        const int numChunks = chunkStarts.size()-1;
+
+        //First pass: counting data lines in each chunk, to know where each chunk begins in the file element order
+        std::vector<long> lineStarts(numChunks+1,0);
+        igl::parallel_for(numChunks, [&](const int c){
+            long numLines=0;
+            for (const char* q=chunkStarts[c];q<chunkStarts[c+1];q=next_text_line(q, chunkStarts[c+1]))
+                if (!is_text_blank(skip_text_spaces(q, chunkStarts[c+1]), chunkStarts[c+1]))
+                    numLines++;
+            lineStarts[c+1]=numLines;
+        }, 2);
+        for (int c=0;c<numChunks;c++)
+            lineStarts[c+1]+=lineStarts[c];
+        if (lineStarts[numChunks]<numV+numF)
+            return false;
+
+        //Second pass: parsing vertices, and counting the triangles of every chunk
+        V.resize(numV,3);
+        std::vector<long> triangleStarts(numChunks+1,0);
+        std::vector<char> chunkValid(numChunks,1);
+        igl::parallel_for(numChunks, [&](const int c){
+            long currLine=lineStarts[c];
+            const char* chunkEnd = chunkStarts[c+1];
+            for (const char* q=chunkStarts[c];(q<chunkEnd)&&(currLine<numV+numF);q=next_text_line(q, chunkEnd)){
+                q = skip_text_spaces(q, chunkEnd);
+                if (is_text_blank(q, chunkEnd))
+                    continue;
+                if (currLine<numV){
+                    for (int j=0;j<3;j++)
+                        if (!parse_text_double(q, chunkEnd, V(currLine,j)))
+                            chunkValid[c]=0;
+                } else {
+                    long faceSize;
+                    if ((!parse_text_int(q, chunkEnd, faceSize))||(faceSize<3))
+                        chunkValid[c]=0;
+                    else
+                        triangleStarts[c+1]+=faceSize-2;
+                }
+                currLine++;
+            }
+        }, 2);
+        for (int c=0;c<numChunks;c++){
+            if (!chunkValid[c])
+                return false;
+            triangleStarts[c+1]+=triangleStarts[c];
+        }
+
+        //Third pass: parsing (and triangulating) faces
+        F.resize(triangleStarts[numChunks],3);
+        igl::parallel_for(numChunks, [&](const int c){
+            long currLine=lineStarts[c];
+            long currTriangle=triangleStarts[c];
+            const char* chunkEnd = chunkStarts[c+1];
+            for (const char* q=chunkStarts[c];(q<chunkEnd)&&(currLine<numV+numF);q=next_text_line(q, chunkEnd)){
+                q = skip_text_spaces(q, chunkEnd);
+                if (is_text_blank(q, chunkEnd))
+                    continue;
+                if (currLine++<numV)
+                    continue;
+                long faceSize=0, first=0, prev=0, curr;
+                parse_text_int(q, chunkEnd, faceSize);
+                for (long j=0;j<faceSize;j++){
+                    if ((!parse_text_int(q, chunkEnd, curr))||(curr<0)||(curr>=numV)){
+                        chunkValid[c]=0;
+                        break;
+                    }
+                    if (j==0)
+                        first=curr;
+                    if (j>=2){
+                        F(currTriangle,0)=first;
+                        F(currTriangle,1)=prev;
+                        F(currTriangle,2)=curr;
+                        currTriangle++;
+                    }
+                    prev=curr;
+                }
+            }
+        }, 2);
+        for (int c=0;c<numChunks;c++)
+            if (!chunkValid[c])
+                return false;
+
+        return true;
+    }
+
+    // Reads an OFF file with parallel_readOFF() into a mesh object.
+    bool IGL_INLINE parallel_readOFF(const std::string& fileName,
+                                     directional::TriMesh& mesh,
+                                     const bool useMmap=true){
+        Eigen::MatrixXd V;
+        Eigen::MatrixXi F;
+        if (!parallel_readOFF(fileName,V,F,useMmap))
+            return false;
+        mesh.set_mesh(V,F);
+        return true;
+    }
+}
+
+#endif
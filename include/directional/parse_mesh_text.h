@@ -0,0 +1,147 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2022 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_PARSE_MESH_TEXT_H
+#define DIRECTIONAL_PARSE_MESH_TEXT_H
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/***
+ Low-level helpers for the parallel text mesh readers (parallel_readOFF.h, parallel_readOBJ.h).
+ All functions work on a non null-terminated range [p, end), advancing p past what they consumed.
+***/
+
+namespace directional{
+
+    const size_t textChunkSize = (1<<22);  //Size of the chunks that are parsed in parallel
+
+    inline bool is_text_space(const char c){ return (c==' ')||(c=='\t')||(c=='\r')||(c=='\v')||(c=='\f'); }
+
+    //Skips spaces and tabs (but not newlines)
+    inline const char* skip_text_spaces(const char* p, const char* end){
+        while ((p<end)&&(is_text_space(*p)))
+            p++;
+        return p;
+    }
+
+    //Returns the beginning of the next line
+    inline const char* next_text_line(const char* p, const char* end){
+        const char* newLine = (const char*)std::memchr(p, '\n', end-p);
+        return (newLine==NULL ? end : newLine+1);
+    }
+
+    //Whether the (already space-skipped) position is at an empty or comment line.
+    inline bool is_text_blank(const char* p, const char* end){
+        return ((p==end)||(*p=='\n')||(*p=='#'));
+    }
+
+    inline bool parse_text_int(const char*& p, const char* end, long& value){
+        p = skip_text_spaces(p, end);
+        bool negative = false;
+        if ((p<end)&&((*p=='-')||(*p=='+'))){
+            negative = (*p=='-');
+            p++;
+        }
+        if ((p==end)||(*p<'0')||(*p>'9'))
+            return false;
+        long result=0;
+        while ((p<end)&&(*p>='0')&&(*p<='9'))
+            result = 10*result+(*(p++)-'0');
+        value = (negative ? -result : result);
+        return true;
+    }
+
+    //Parses a floating-point number. Decimal numbers with at most 19 significant digits and a small decimal exponent are converted exactly
+    //(a single correctly-rounded multiplication or division by an exact power of ten); anything else (long mantissas, large exponents, inf/nan) falls back to strtod().
+    //Either way the result is the same as strtod().
+    inline bool parse_text_double(const char*& p, const char* end, double& value){
+        static const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                             1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        p = skip_text_spaces(p, end);
+        const char* start = p;
+        bool negative = false;
+        if ((p<end)&&((*p=='-')||(*p=='+'))){
+            negative = (*p=='-');
+            p++;
+        }
+        std::uint64_t mantissa = 0;
+        int numDigits = 0, exponent = 0;
+        bool hasDigits = false;
+        while ((p<end)&&(*p>='0')&&(*p<='9')){
+            hasDigits = true;
+            if (mantissa!=0 || *p!='0')
+                numDigits++;
+            if (numDigits<=19)
+                mantissa = 10*mantissa+(*p-'0');
+            else
+                exponent++;
+            p++;
+        }
+        if ((p<end)&&(*p=='.')){
+            p++;
+            while ((p<end)&&(*p>='0')&&(*p<='9')){
+                hasDigits = true;
+                if (mantissa!=0 || *p!='0')
+                    numDigits++;
+                if (numDigits<=19){
+                    mantissa = 10*mantissa+(*p-'0');
+                    exponent--;
+                }
+                p++;
+            }
+        }
+        if ((p<end)&&((*p=='e')||(*p=='E'))&&hasDigits){
+            const char* expStart = p++;
+            long expValue;
+            if (parse_text_int(p, end, expValue) && (expStart+1<p) && (!is_text_space(expStart[1])))
+                exponent += (int)std::max(-100000L, std::min(100000L, expValue));
+            else
+                p = expStart;
+        }
+
+        const bool delimited = ((p==end)||is_text_space(*p)||(*p=='\n')||(*p=='/')||(*p=='#'));
+        if ((hasDigits)&&(delimited)&&(numDigits<=19)&&(mantissa<=(std::uint64_t(1)<<53))&&(exponent>=-22)&&(exponent<=22)){
+            double result = (double)mantissa;
+            result = (exponent<0 ? result/powersOfTen[-exponent] : result*powersOfTen[exponent]);
+            value = (negative ? -result : result);
+            return true;
+        }
+
+        //slow path
+        char buffer[128];
+        size_t length = 0;
+        p = start;
+        while ((p<end)&&(!is_text_space(*p))&&(*p!='\n')&&(*p!='/')&&(*p!='#')&&(length<sizeof(buffer)-1))
+            buffer[length++] = *(p++);
+        buffer[length] = 0;
+        char* parseEnd;
+        value = std::strtod(buffer, &parseEnd);
+        if (parseEnd==buffer)
+            return false;
+        p = start+(parseEnd-buffer);
+        return true;
+    }
+
+    //Splits [begin, end) into chunks of roughly chunkSize bytes that start at line beginnings.
+    //chunkStarts has #chunks+1 entries, the last being end.
+    inline void split_text_chunks(const char* begin, const char* end, const size_t chunkSize, std::vector<const char*>& chunkStarts){
+        chunkStarts.clear();
+        chunkStarts.push_back(begin);
+        const char* p = begin;
+        while ((size_t)(end-p)>chunkSize){
+            p = next_text_line(p+chunkSize, end);
+            if (p==end)
+                break;
+            chunkStarts.push_back(p);
+        }
+        chunkStarts.push_back(end);
+    }
+}
+
+#endif
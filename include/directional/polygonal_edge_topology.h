@@ -11,6 +11,7 @@
 #include <igl/igl_inline.h>
 #include <Eigen/Core>
 #include <vector>
+#include <algorithm>
 
 
 namespace hedra
@@ -29,6 +30,9 @@ namespace hedra
     // FEs: #F by max(D): if the edge is oriented positively or negatively in the face (e.g. in the example above we get -1)
     // InnerEdges: indices into EV of which edges are internal (not boundary)
 
+    // The halfedges are ordered by (smaller vertex, larger vertex, face, position in face) with two stable counting sorts over flat arrays,
+    // so the construction is linear in the size of the mesh. Consecutive halfedges with the same vertices are paired into an edge,
+    // and the edges are therefore enumerated in lexicographic order of their vertices (as igl::edge_topology() does for triangle meshes).
     IGL_INLINE void polygonal_edge_topology(const Eigen::VectorXi& D,
                                             const Eigen::MatrixXi& F,
                                             Eigen::MatrixXi& EV,
@@ -39,107 +43,89 @@ namespace hedra
                                             Eigen::VectorXi& InnerEdges)
     {
         // Only needs to be edge-manifold
-        std::vector<std::vector<int> > ETT;
-        for(int f=0;f<D.rows();++f)
-            for (int i=0;i<D(f);++i)
-            {
-                // v1 v2 f vi
+        int numH=0, numV=0;
+        for (int f=0;f<D.rows();f++){
+            numH+=D(f);
+            for (int i=0;i<D(f);i++)
+                numV=std::max(numV, F(f,i)+1);
+        }
+
+        //halfedges in face order: halfedge h is (F(HF(h),HFi(h)), F(HF(h),HFi(h)+1)), and (HMin(h),HMax(h)) are its sorted vertices
+        std::vector<int> HMin(numH), HMax(numH), HF(numH), HFi(numH);
+        for (int f=0, h=0;f<D.rows();f++)
+            for (int i=0;i<D(f);i++, h++){
                 int v1 = F(f,i);
                 int v2 = F(f,(i+1)%D(f));
-                if (v1 > v2) std::swap(v1,v2);
-                std::vector<int> r(4);
-                r[0] = v1; r[1] = v2;
-                r[2] = f;  r[3] = i;
-                ETT.push_back(r);
+                HMin[h]=std::min(v1,v2);
+                HMax[h]=std::max(v1,v2);
+                HF[h]=f;
+                HFi[h]=i;
             }
-        std::sort(ETT.begin(),ETT.end());
-        
+
+        //stable counting sort by the larger vertex and then by the smaller one
+        std::vector<int> bucketStart(numV+1);
+        auto counting_sort = [&](const std::vector<int>& key, const std::vector<int>& in, std::vector<int>& out){
+            std::fill(bucketStart.begin(), bucketStart.end(), 0);
+            for (int j=0;j<numH;j++)
+                bucketStart[key[in[j]]+1]++;
+            for (int v=0;v<numV;v++)
+                bucketStart[v+1]+=bucketStart[v];
+            for (int j=0;j<numH;j++)
+                out[bucketStart[key[in[j]]]++]=in[j];
+        };
+        std::vector<int> faceOrder(numH), maxOrder(numH), sortedH(numH);
+        for (int h=0;h<numH;h++)
+            faceOrder[h]=h;
+        counting_sort(HMax, faceOrder, maxOrder);
+        counting_sort(HMin, maxOrder, sortedH);
+
         // count the number of edges (assume manifoldness)
-        int En = 1; // the last is always counted
-        for(unsigned i=0;i<ETT.size()-1;++i)
-            if (!((ETT[i][0] == ETT[i+1][0]) && (ETT[i][1] == ETT[i+1][1])))
-                ++En;
-        
-        EV = Eigen::MatrixXi::Constant((int)(En),2,-1);
-        FE = Eigen::MatrixXi::Constant((int)(F.rows()),(int)(F.cols()),-1);
-        EF = Eigen::MatrixXi::Constant((int)(En),2,-1);
-        En = 0;
-        
-        for(unsigned i=0;i<ETT.size();++i)
-        {
-            if (i == ETT.size()-1 ||
-                !((ETT[i][0] == ETT[i+1][0]) && (ETT[i][1] == ETT[i+1][1]))
-                )
-            {
-                // Border edge
-                std::vector<int>& r1 = ETT[i];
-                EV(En,0)     = r1[0];
-                EV(En,1)     = r1[1];
-                EF(En,0)    = r1[2];
-                FE(r1[2],r1[3]) = En;
-            }
-            else
-            {
-                std::vector<int>& r1 = ETT[i];
-                std::vector<int>& r2 = ETT[i+1];
-                EV(En,0)     = r1[0];
-                EV(En,1)     = r1[1];
-                EF(En,0)    = r1[2];
-                EF(En,1)    = r2[2];
-                FE(r1[2],r1[3]) = En;
-                FE(r2[2],r2[3]) = En;
-                ++i; // skip the next one
-            }
-            ++En;
+        int En = 0;
+        for (int j=0;j<numH;j++){
+            if ((j<numH-1) && (HMin[sortedH[j]]==HMin[sortedH[j+1]]) && (HMax[sortedH[j]]==HMax[sortedH[j+1]]))
+                j++;
+            En++;
         }
-        
-        // Sort the relation EF, accordingly to EV
-        // the first one is the face on the left of the edge
-        
-        for(unsigned i=0; i<EF.rows(); ++i)
-        {
-            int fid = EF(i,0);
-            bool flip = true;
-            // search for edge EV.row(i)
-            for (unsigned j=0; j<D(fid); ++j)
-            {
-                if ((F(fid,j) == EV(i,0)) && (F(fid,(j+1)%D(fid)) == EV(i,1)))
-                    flip = false;
+
+        EV = Eigen::MatrixXi::Constant(En,2,-1);
+        FE = Eigen::MatrixXi::Constant(F.rows(),F.cols(),-1);
+        EF = Eigen::MatrixXi::Constant(En,2,-1);
+        EFi = Eigen::MatrixXi::Constant(En,2,-1);
+        En = 0;
+        for (int j=0;j<numH;j++){
+            int h1=sortedH[j];
+            EV(En,0) = HMin[h1];
+            EV(En,1) = HMax[h1];
+            EF(En,0) = HF[h1];
+            EFi(En,0) = HFi[h1];
+            FE(HF[h1],HFi[h1]) = En;
+            if ((j<numH-1) && (HMin[h1]==HMin[sortedH[j+1]]) && (HMax[h1]==HMax[sortedH[j+1]])){
+                int h2=sortedH[++j];
+                EF(En,1) = HF[h2];
+                EFi(En,1) = HFi[h2];
+                FE(HF[h2],HFi[h2]) = En;
             }
-            
-            if (flip)
-            {
-                int tmp = EF(i,0);
-                EF(i,0) = EF(i,1);
-                EF(i,1) = tmp;
+
+            // the first face is the one on the left of the edge (where it is oriented from EV(En,0) to EV(En,1))
+            if (F(HF[h1],HFi[h1])!=EV(En,0)){
+                std::swap(EF(En,0),EF(En,1));
+                std::swap(EFi(En,0),EFi(En,1));
             }
+            En++;
         }
-        
-        
+
         std::vector<int> InnerEdgesVec;
-        EFi=Eigen::MatrixXi::Constant(EF.rows(), 2,-1);
         FEs=Eigen::MatrixXd::Zero(FE.rows(),FE.cols());
-        for (int i=0;i<EF.rows();i++)
-            for (int k=0;k<2;k++){
-                if (EF(i,k)==-1)
-                    continue;
-                    
-                for (int j=0;j<D(EF(i,k));j++)
-                    if (FE(EF(i,k),j)==i)
-                        EFi(i,k)=j;
-            }
-        
         for (int i=0;i<EF.rows();i++){
             if (EFi(i,0)!=-1) FEs(EF(i,0),EFi(i,0))=1.0;
             if (EFi(i,1)!=-1) FEs(EF(i,1),EFi(i,1))=-1.0;
             if ((EF(i,0)!=-1)&&(EF(i,1)!=-1))
                 InnerEdgesVec.push_back(i);
         }
-        
+
         InnerEdges.resize(InnerEdgesVec.size());
         for (int i=0;i<InnerEdgesVec.size();i++)
             InnerEdges(i)=InnerEdgesVec[i];
-        
 
     }
 }
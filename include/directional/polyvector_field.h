@@ -16,13 +16,70 @@
 #include <igl/speye.h>
 #include <igl/eigs.h>
 #include <iostream>
-#include <directional/complex_eigs.h>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <limits>
+#include <functional>
+#include <igl/parallel_for.h>
+#include <Eigen/IterativeLinearSolvers>
+#include <directional/hermitian_eigs.h>
+#include <directional/conjugate_gradient.h>
+#include <directional/connection_laplacian.h>
 #include <directional/TangentBundle.h>
 #include <directional/CartesianField.h>
 
 namespace directional
 {
 
+    //Cached state of the linear solver of polyvector_field(), so that repeated solves with new constraint values or weights do not redo the work that does not depend on them:
+    //the smoothness and rotational-symmetry operators are only multiplied out when polyvector_precompute() actually changes them, the symbolic analysis is only redone
+    //when the sparsity pattern of the reduced system changes, and the numeric factorization only when its values change (otherwise only the right-hand side is new).
+    //Copying a PolyVectorData does not copy this cache.
+    struct PolyVectorSolverState{
+    public:
+
+        bool operatorsValid;                                            // whether smoothLhs and roSyLhs correspond to the current operators of the PolyVectorData
+        Eigen::SparseMatrix<std::complex<double>> smoothLhs, roSyLhs;   // smoothMat^* WSmooth smoothMat and roSyMat^* WRoSy roSyMat, without the energy weights
+
+        bool patternAnalyzed;                                           // whether solver holds the symbolic analysis of the pattern of totalLhs
+        bool factorized;                                                // whether solver holds the numeric factorization of totalLhs
+        Eigen::SparseMatrix<std::complex<double>> totalLhs;             // the last reduced system given to the solver
+        Eigen::SimplicialLDLT<Eigen::SparseMatrix<std::complex<double>>> solver;
+
+        std::vector<Eigen::VectorXcd> addedConstSolves;                 // totalLhs^-1 * addedConstRows[i]^*, for the first constraints added by polyvector_add_constraint()
+        Eigen::VectorXcd lastReducedDofs;                               // the last solution, which warm-starts the iterative solver
+
+        PolyVectorSolverState():operatorsValid(false), patternAnalyzed(false), factorized(false){}
+        PolyVectorSolverState(const PolyVectorSolverState&):operatorsValid(false), patternAnalyzed(false), factorized(false){}
+        PolyVectorSolverState& operator=(const PolyVectorSolverState&){ reset(); return *this; }
+        ~PolyVectorSolverState(){}
+
+        void reset(){
+            operatorsValid=patternAnalyzed=factorized=false;
+            addedConstSolves.clear();
+            lastReducedDofs.resize(0);
+        }
+
+        //makes solver hold the factorization of the (compressed) totalLhs, redoing only the stages that changed
+        void factorize(const Eigen::SparseMatrix<std::complex<double>>& newTotalLhs){
+            bool samePattern = patternAnalyzed && (newTotalLhs.rows()==totalLhs.rows()) && (newTotalLhs.cols()==totalLhs.cols()) && (newTotalLhs.nonZeros()==totalLhs.nonZeros()) &&
+                               std::equal(newTotalLhs.outerIndexPtr(), newTotalLhs.outerIndexPtr()+newTotalLhs.outerSize()+1, totalLhs.outerIndexPtr()) &&
+                               std::equal(newTotalLhs.innerIndexPtr(), newTotalLhs.innerIndexPtr()+newTotalLhs.nonZeros(), totalLhs.innerIndexPtr());
+            bool sameValues = samePattern && factorized && std::equal(newTotalLhs.valuePtr(), newTotalLhs.valuePtr()+newTotalLhs.nonZeros(), totalLhs.valuePtr());
+            if (!samePattern){
+                solver.analyzePattern(newTotalLhs);
+                patternAnalyzed=true;
+            }
+            if (!sameValues){
+                solver.factorize(newTotalLhs);
+                factorized = (solver.info() == Eigen::Success);
+                totalLhs = newTotalLhs;
+                addedConstSolves.clear();
+            }
+        }
+    };
+
     //Data for the precomputation of the PolyVector algorithm
     struct PolyVectorData{
     public:
@@ -50,84 +107,60 @@ namespace directional
         Eigen::SparseMatrix<std::complex<double>> WSmooth, WAlign, WRoSy, M;
         double totalRoSyWeight, totalConstrainedWeight, totalSmoothWeight;    //for co-scaling energies
 
-        PolyVectorData():signSymmetry(true),  wSmooth(1.0), wRoSy(0.0) {wAlignment.resize(0); constSpaces.resize(0); constVectors.resize(0,3);}
+        //Hard constraints added by polyvector_add_constraint() after the precomputation. They are not reduced out of the system, but are enforced on top of its factorization
+        int numReducedConstraints;                                  //the first numReducedConstraints of constSpaces are reduced by polyvector_precompute(), the rest were added
+        std::vector<Eigen::SparseVector<std::complex<double>>> addedConstRows;   //the linear constraint on the reduced dofs of each added constraint (empty if it overconstrains its space)
+        std::vector<std::complex<double>> addedConstRhs;                        //addedConstRows[i]*dofs = addedConstRhs[i]
+
+        //Iterative solver, for meshes on which a sparse factorization does not fit in memory
+        bool iterativeSolver;                       //Whether polyvector_field() solves by preconditioned conjugate gradient, instead of factorizing the system
+        preconditionerEnum preconditioner;          //JACOBI applies the system without forming it, in memory linear in the field size; INCOMPLETE_CHOLESKY assembles it and its incomplete factor
+        double iterativeTolerance;                  //Relative residual at which conjugate gradient stops
+        int iterativeMaxIterations;
+
+        mutable PolyVectorSolverState solverState;                           //reused by polyvector_field() between solves
+
+        PolyVectorData():signSymmetry(true),  wSmooth(1.0), wRoSy(0.0), numReducedConstraints(0), iterativeSolver(false), preconditioner(preconditionerEnum::JACOBI), iterativeTolerance(1e-10), iterativeMaxIterations(100000) {wAlignment.resize(0); constSpaces.resize(0); constVectors.resize(0,3);}
         ~PolyVectorData(){}
     };
 
 
-    // Precalculate the operators needed for PolyVector computation according to the user-prescribed parameters. Must be called whenever any of them changes
+    // Builds the constraint-dependent operators of the PolyVector system (the hard-constraint reduction and the soft alignment) for the given constraint vectors,
+    // with the constraint pattern (constSpaces, wAlignment), degree and symmetry already set in pvData. Called by polyvector_precompute(), and by polyvector_fields() per configuration.
     // Input:
-    //  tb:     underlying tangent bundle
-    //  N:      degree of the field
-    //
+    //  tb:             underlying tangent bundle
+    //  pvData:         PolyVector data, of which only the parameters are used
+    //  constVectors:   #constSpaces x 3 constraint vectors, replacing pvData.constVectors
     // Output:
-    //  pvField: POLYVECTOR_FIELD cartesian field initalized with the tangent bundle
-    //  pvData:  Updated structure with all operators
-    IGL_INLINE void polyvector_precompute(const directional::TangentBundle& tb,
-                                          const int N,
-                                          directional::CartesianField& pvField,
-                                          PolyVectorData& pvData)
+    //  reducMat, reducRhs, alignMat, WAlign, alignRhs, totalConstrainedWeight: as in PolyVectorData
+    IGL_INLINE void polyvector_constraint_operators(const directional::TangentBundle& tb,
+                                                    const PolyVectorData& pvData,
+                                                    const Eigen::MatrixXd& constVectors,
+                                                    Eigen::SparseMatrix<std::complex<double>>& reducMat,
+                                                    Eigen::VectorXcd& reducRhs,
+                                                    Eigen::SparseMatrix<std::complex<double>>& alignMat,
+                                                    Eigen::SparseMatrix<std::complex<double>>& WAlign,
+                                                    Eigen::VectorXcd& alignRhs,
+                                                    double& totalConstrainedWeight)
     {
-
         using namespace std;
         using namespace Eigen;
 
-        pvField.init(tb, fieldTypeEnum::POLYVECTOR_FIELD, N);
-
-        //Building the smoothness matrices, with an energy term for each inner edge and degree
-        int rowCounter=0;
-        std::vector< Triplet<complex<double> > > dTriplets, WTriplets;
-        pvData.N = N;
-        pvData.sizeT = pvField.intField.rows();
-        if (pvData.N%2!=0) pvData.signSymmetry=false;  //it has to be for odd N
-
-        pvData.totalSmoothWeight = pvField.tb->connectionMass.sum();
-
-        vector<Triplet<complex<double>>> WSmoothTriplets, MTriplets;
-        for (int n = 0; n < pvData.N; n++)
-        {
-            for (int i=0;i<pvField.tb->adjSpaces.rows();i++)
-            {
-                if ((pvField.tb->adjSpaces(i,0)==-1)||(pvField.tb->adjSpaces(i,1)==-1))
-                    continue;  //boundary edge
-
-                // differential matrix between two tangent spaces
-                dTriplets.push_back(Triplet<complex<double> >(rowCounter, n*pvField.intField.rows()+pvField.tb->adjSpaces(i,0), pow(pvField.tb->connection(i),pvData.N-n)));
-                dTriplets.push_back(Triplet<complex<double> >(rowCounter, n*pvField.intField.rows()+pvField.tb->adjSpaces(i,1), -1.0));
-
-                //stiffness weights
-                WSmoothTriplets.push_back(Triplet<complex<double> >(rowCounter, rowCounter, pvField.tb->connectionMass(i)));
-                rowCounter++;
-            }
-
-            for (int i=0;i<pvField.intField.rows();i++)
-                MTriplets.push_back(Triplet<complex<double>>(n*pvField.intField.rows()+i, n*pvField.intField.rows()+i, pvField.tb->tangentSpaceMass(i)));
-        }
-
-        pvData.smoothMat.resize(rowCounter, pvData.N*pvField.intField.rows());
-        pvData.smoothMat.setFromTriplets(dTriplets.begin(), dTriplets.end());
-
-        pvData.WSmooth.resize(rowCounter, rowCounter);
-        pvData.WSmooth.setFromTriplets(WSmoothTriplets.begin(), WSmoothTriplets.end());
-
-        pvData.M.resize(pvData.N*pvField.intField.rows(), pvData.N*pvField.intField.rows());
-        pvData.M.setFromTriplets(MTriplets.begin(), MTriplets.end());
-
         //creating reduction transformation
-        VectorXi numSpaceConstraints = Eigen::VectorXi::Zero(pvField.intField.rows());
-        int realN = (pvData.signSymmetry ? N/2 : N);
+        VectorXi numSpaceConstraints = Eigen::VectorXi::Zero(pvData.sizeT);
+        int realN = (pvData.signSymmetry ? pvData.N/2 : pvData.N);
         realN = (pvData.wRoSy < 0.0 ? 1 : realN);
         //MatrixXcd faceConstraints(F.rows(),realN);
-        std::vector<MatrixXcd> localSpaceReducMats; localSpaceReducMats.resize(pvField.intField.rows());
-        std::vector<VectorXcd> localSpaceReducRhs;  localSpaceReducRhs.resize(pvField.intField.rows());
+        std::vector<MatrixXcd> localSpaceReducMats; localSpaceReducMats.resize(pvData.sizeT);
+        std::vector<VectorXcd> localSpaceReducRhs;  localSpaceReducRhs.resize(pvData.sizeT);
 
-        for (int i=0;i<pvField.intField.rows();i++){
+        for (int i=0;i<pvData.sizeT;i++){
             localSpaceReducMats[i]=MatrixXcd::Identity(realN,realN);
             localSpaceReducRhs[i]=VectorXcd::Zero(realN);
         }
 
         /*************Hard-constraint reduction matrices******************/
-        MatrixXd constVectorsIntrinsic=pvField.tb->project_to_intrinsic(pvData.constSpaces,pvData.constVectors);
+        MatrixXd constVectorsIntrinsic=tb.project_to_intrinsic(pvData.constSpaces,constVectors);
         //cout<<"constVectorsIntrinsic: "<<constVectorsIntrinsic<<endl;
         for (int i=0;i<pvData.constSpaces.size();i++){
             if (pvData.wAlignment(i)>=0.0)
@@ -139,7 +172,7 @@ namespace directional
 
             complex<double> constVectorComplexRaw = complex<double>(constVectorsIntrinsic(i,0),constVectorsIntrinsic(i,1));
             complex<double> constVectorComplex = (pvData.signSymmetry ? constVectorComplexRaw*constVectorComplexRaw : constVectorComplexRaw);
-            constVectorComplex = (pvData.wRoSy < 0.0 ? pow(constVectorComplexRaw, N) :constVectorComplex);
+            constVectorComplex = (pvData.wRoSy < 0.0 ? pow(constVectorComplexRaw, pvData.N) :constVectorComplex);
 
             MatrixXcd singleReducMat=MatrixXcd::Zero(realN-currSpaceNumDof,realN-currSpaceNumDof-1);
             VectorXcd singleReducRhs=VectorXcd::Zero(realN-currSpaceNumDof);
@@ -159,53 +192,31 @@ namespace directional
 
         //creating the global reduction matrices
         double colCounter=0;
-        pvData.reducRhs=VectorXcd::Zero(pvData.N*pvField.intField.rows());
+        reducRhs=VectorXcd::Zero(pvData.N*pvData.sizeT);
         vector<Triplet<complex<double>>> reducMatTriplets;
         int jump = (pvData.signSymmetry ? 2 : 1);
         jump = (pvData.wRoSy < 0.0 ? pvData.N : jump);
-        for (int i=0;i<pvField.intField.rows();i++){
+        for (int i=0;i<pvData.sizeT;i++){
             for (int j=0;j<pvData.N;j+=jump){
                 for (int k=0;k<localSpaceReducMats[i].cols();k++)
-                    reducMatTriplets.push_back(Triplet<complex<double>>(j*pvField.intField.rows()+i, colCounter+k, localSpaceReducMats[i](j/jump,k)));
+                    reducMatTriplets.push_back(Triplet<complex<double>>(j*pvData.sizeT+i, colCounter+k, localSpaceReducMats[i](j/jump,k)));
 
-                pvData.reducRhs(j*pvField.intField.rows()+i) = localSpaceReducRhs[i](j/jump);
+                reducRhs(j*pvData.sizeT+i) = localSpaceReducRhs[i](j/jump);
             }
 
             colCounter+=localSpaceReducMats[i].cols();
         }
 
-        pvData.reducMat.resize(pvData.N*pvField.intField.rows(), colCounter);
-        pvData.reducMat.setFromTriplets(reducMatTriplets.begin(), reducMatTriplets.end());
-
-
-        /****************rotational-symmetry matrices********************/
-        //TODO: use new massweights
-        if (pvData.wRoSy >= 0.0){ //this is anyhow enforced, this matrix is unnecessary)
-            vector<Triplet<complex<double>>> roSyTriplets, WRoSyTriplets;
-            for (int i=pvField.intField.rows();i<pvData.N*pvField.intField.rows();i++){
-                roSyTriplets.push_back(Triplet<complex<double>>(i,i,1.0));
-                WRoSyTriplets.push_back(Triplet<complex<double>>(i,i,pvField.tb->tangentSpaceMass(i%pvField.intField.rows())));
-            }
+        reducMat.resize(pvData.N*pvData.sizeT, colCounter);
+        reducMat.setFromTriplets(reducMatTriplets.begin(), reducMatTriplets.end());
 
-            pvData.roSyMat.resize(N*pvField.intField.rows(), N*pvField.intField.rows());
-            pvData.roSyMat.setFromTriplets(roSyTriplets.begin(), roSyTriplets.end());
-
-            pvData.WRoSy.resize(N*pvField.intField.rows(), N*pvField.intField.rows());
-            pvData.WRoSy.setFromTriplets(WRoSyTriplets.begin(), WRoSyTriplets.end());
-
-            pvData.totalRoSyWeight=((double)pvData.N)*pvField.tb->tangentSpaceMass.sum();
-        } else {
-            pvData.roSyMat.resize(0, N*pvField.intField.rows());
-            pvData.WRoSy.resize(0,0);  //Even necessary?
-            pvData.totalRoSyWeight=1.0;
-        }
 
         /*****************Soft alignment matrices*******************/
-        rowCounter=0;
+        int rowCounter=0;
         vector<Triplet<complex<double>>> alignTriplets;
         vector<VectorXcd> alignRhsList;
         vector<Triplet<complex<double>>> WAlignTriplets;
-        pvData.totalConstrainedWeight=0.0;
+        totalConstrainedWeight=0.0;
         bool noSoftAlignment = true;
         for (int i=0;i<pvData.constSpaces.size();i++){
             if (pvData.wAlignment(i)<0.0)
@@ -213,10 +224,10 @@ namespace directional
 
             noSoftAlignment=false;
 
-            //complex<double> constVectorComplexSingle=std::complex<double>(pvData.constVectors.row(i).dot(mesh.Bx.row(pvData.constSpaces(i))), pvData.constVectors.row(i).dot(mesh.By.row(pvData.constSpaces(i))));
+            //complex<double> constVectorComplexSingle=std::complex<double>(constVectors.row(i).dot(mesh.Bx.row(pvData.constSpaces(i))), constVectors.row(i).dot(mesh.By.row(pvData.constSpaces(i))));
             complex<double> constVectorComplexRaw = complex<double>(constVectorsIntrinsic(i,0),constVectorsIntrinsic(i,1));
             complex<double> constVectorComplex = (pvData.signSymmetry ? constVectorComplexRaw*constVectorComplexRaw : constVectorComplexRaw);
-            constVectorComplex = (pvData.wRoSy < 0.0 ? pow(constVectorComplexRaw, N) : constVectorComplex);
+            constVectorComplex = (pvData.wRoSy < 0.0 ? pow(constVectorComplexRaw, pvData.N) : constVectorComplex);
             numSpaceConstraints(pvData.constSpaces(i))++;
             //faceConstraints(pvData.constSpaces(i), numSpaceConstraints(pvData.constSpaces(i))++) = constVectorComplex;
 
@@ -236,32 +247,160 @@ namespace directional
             singleReducRhs = IAiA*singleReducRhs;
             for (int j=0;j<IAiA.rows();j++)
                 for (int k=0;k<IAiA.cols();k++)
-                    alignTriplets.push_back(Triplet<complex<double>>(rowCounter+j, k*jump*pvField.intField.rows()+pvData.constSpaces(i), IAiA(j,k)));
+                    alignTriplets.push_back(Triplet<complex<double>>(rowCounter+j, k*jump*pvData.sizeT+pvData.constSpaces(i), IAiA(j,k)));
 
             alignRhsList.push_back(singleReducRhs);
             for (int j=0;j<singleReducRhs.size();j++){
-                WAlignTriplets.push_back(Triplet<complex<double>>(rowCounter+j, rowCounter+j, pvData.wAlignment(i)*pvField.tb->tangentSpaceMass(pvData.constSpaces(i))));
-                pvData.totalConstrainedWeight+=pvField.tb->tangentSpaceMass(pvData.constSpaces(i));
+                WAlignTriplets.push_back(Triplet<complex<double>>(rowCounter+j, rowCounter+j, pvData.wAlignment(i)*tb.tangentSpaceMass(pvData.constSpaces(i))));
+                totalConstrainedWeight+=tb.tangentSpaceMass(pvData.constSpaces(i));
             }
             rowCounter+=realN;
         }
 
         if (noSoftAlignment)
-            pvData.totalConstrainedWeight=1.0;  //it wouldn't be used, except just to avoid a division by zero in the energy formulation
+            totalConstrainedWeight=1.0;  //it wouldn't be used, except just to avoid a division by zero in the energy formulation
 
-        pvData.alignRhs.resize(rowCounter);
+        alignRhs.resize(rowCounter);
         for (int i=0;i<alignRhsList.size();i++)
-            pvData.alignRhs.segment(i*realN,realN)=alignRhsList[i];
+            alignRhs.segment(i*realN,realN)=alignRhsList[i];
+
+        alignMat.resize(rowCounter, pvData.N*pvData.sizeT);
+        alignMat.setFromTriplets(alignTriplets.begin(), alignTriplets.end());
+
+        WAlign.resize(rowCounter,rowCounter);
+        WAlign.setFromTriplets(WAlignTriplets.begin(), WAlignTriplets.end());
+    }
+
+
+    // Precalculate the operators needed for PolyVector computation according to the user-prescribed parameters. Must be called whenever any of them changes
+    // Input:
+    //  tb:     underlying tangent bundle
+    //  N:      degree of the field
+    //
+    // Output:
+    //  pvField: POLYVECTOR_FIELD cartesian field initalized with the tangent bundle
+    //  pvData:  Updated structure with all operators
+    IGL_INLINE void polyvector_precompute(const directional::TangentBundle& tb,
+                                          const int N,
+                                          directional::CartesianField& pvField,
+                                          PolyVectorData& pvData)
+    {
+
+        using namespace std;
+        using namespace Eigen;
+
+        pvField.init(tb, fieldTypeEnum::POLYVECTOR_FIELD, N);
+
+        //Building the smoothness matrices, with an energy term for each inner edge and degree
+        int rowCounter=0;
+        std::vector< Triplet<complex<double> > > dTriplets, WTriplets;
+        pvData.N = N;
+        pvData.sizeT = pvField.intField.rows();
+        if (pvData.N%2!=0) pvData.signSymmetry=false;  //it has to be for odd N
+
+        pvData.totalSmoothWeight = pvField.tb->connectionMass.sum();
+
+        vector<Triplet<complex<double>>> WSmoothTriplets, MTriplets;
+        for (int n = 0; n < pvData.N; n++)
+        {
+            for (int i=0;i<pvField.tb->adjSpaces.rows();i++)
+            {
+                if ((pvField.tb->adjSpaces(i,0)==-1)||(pvField.tb->adjSpaces(i,1)==-1))
+                    continue;  //boundary edge
+
+                // differential matrix between two tangent spaces
+                dTriplets.push_back(Triplet<complex<double> >(rowCounter, n*pvField.intField.rows()+pvField.tb->adjSpaces(i,0), pow(pvField.tb->connection(i),pvData.N-n)));
+                dTriplets.push_back(Triplet<complex<double> >(rowCounter, n*pvField.intField.rows()+pvField.tb->adjSpaces(i,1), -1.0));
+
+                //stiffness weights
+                WSmoothTriplets.push_back(Triplet<complex<double> >(rowCounter, rowCounter, pvField.tb->connectionMass(i)));
+                rowCounter++;
+            }
 
-        pvData.alignMat.resize(rowCounter, N*pvField.intField.rows());
-        pvData.alignMat.setFromTriplets(alignTriplets.begin(), alignTriplets.end());
+            for (int i=0;i<pvField.intField.rows();i++)
+                MTriplets.push_back(Triplet<complex<double>>(n*pvField.intField.rows()+i, n*pvField.intField.rows()+i, pvField.tb->tangentSpaceMass(i)));
+        }
+
+        //the cached operators of the solver stay valid if the smoothness and rotational-symmetry operators come out the same (e.g., when only the constraints change)
+        auto same_operator = [](const SparseMatrix<complex<double>>& A, const SparseMatrix<complex<double>>& B){
+            return ((A.rows()==B.rows())&&(A.cols()==B.cols())&&(A.nonZeros()==B.nonZeros())&&
+                    std::equal(A.outerIndexPtr(), A.outerIndexPtr()+A.outerSize()+1, B.outerIndexPtr())&&
+                    std::equal(A.innerIndexPtr(), A.innerIndexPtr()+A.nonZeros(), B.innerIndexPtr())&&
+                    std::equal(A.valuePtr(), A.valuePtr()+A.nonZeros(), B.valuePtr()));
+        };
 
-        pvData.WAlign.resize(rowCounter,rowCounter);
-        pvData.WAlign.setFromTriplets(WAlignTriplets.begin(), WAlignTriplets.end());
+        SparseMatrix<complex<double>> smoothMat(rowCounter, pvData.N*pvField.intField.rows());
+        smoothMat.setFromTriplets(dTriplets.begin(), dTriplets.end());
+
+        SparseMatrix<complex<double>> WSmooth(rowCounter, rowCounter);
+        WSmooth.setFromTriplets(WSmoothTriplets.begin(), WSmoothTriplets.end());
+
+        bool sameOperators = same_operator(smoothMat, pvData.smoothMat) && same_operator(WSmooth, pvData.WSmooth);
+        pvData.smoothMat = smoothMat;
+        pvData.WSmooth = WSmooth;
+
+        pvData.M.resize(pvData.N*pvField.intField.rows(), pvData.N*pvField.intField.rows());
+        pvData.M.setFromTriplets(MTriplets.begin(), MTriplets.end());
+
+        /****************rotational-symmetry matrices********************/
+        //TODO: use new massweights
+        if (pvData.wRoSy >= 0.0){ //this is anyhow enforced, this matrix is unnecessary)
+            vector<Triplet<complex<double>>> roSyTriplets, WRoSyTriplets;
+            for (int i=pvField.intField.rows();i<pvData.N*pvField.intField.rows();i++){
+                roSyTriplets.push_back(Triplet<complex<double>>(i,i,1.0));
+                WRoSyTriplets.push_back(Triplet<complex<double>>(i,i,pvField.tb->tangentSpaceMass(i%pvField.intField.rows())));
+            }
+
+            SparseMatrix<complex<double>> roSyMat(N*pvField.intField.rows(), N*pvField.intField.rows());
+            roSyMat.setFromTriplets(roSyTriplets.begin(), roSyTriplets.end());
+
+            SparseMatrix<complex<double>> WRoSy(N*pvField.intField.rows(), N*pvField.intField.rows());
+            WRoSy.setFromTriplets(WRoSyTriplets.begin(), WRoSyTriplets.end());
+
+            sameOperators = sameOperators && same_operator(roSyMat, pvData.roSyMat) && same_operator(WRoSy, pvData.WRoSy);
+            pvData.roSyMat = roSyMat;
+            pvData.WRoSy = WRoSy;
+
+            pvData.totalRoSyWeight=((double)pvData.N)*pvField.tb->tangentSpaceMass.sum();
+        } else {
+            sameOperators = sameOperators && (pvData.roSyMat.rows()==0) && (pvData.roSyMat.cols()==N*pvField.intField.rows());
+            pvData.roSyMat.resize(0, N*pvField.intField.rows());
+            pvData.WRoSy.resize(0,0);  //Even necessary?
+            pvData.totalRoSyWeight=1.0;
+        }
+
+        /*************Hard-constraint reduction and soft alignment matrices******************/
+        pvData.numReducedConstraints = pvData.constSpaces.size();
+        pvData.addedConstRows.clear();
+        pvData.addedConstRhs.clear();
+        polyvector_constraint_operators(*pvField.tb, pvData, pvData.constVectors, pvData.reducMat, pvData.reducRhs, pvData.alignMat, pvData.WAlign, pvData.alignRhs, pvData.totalConstrainedWeight);
+
+        if (!sameOperators)
+            pvData.solverState.operatorsValid=false;
+    }
+
+
+    // The weighted smoothness and rotational-symmetry part of the unreduced PolyVector system matrix. The products of the operators are cached in pvData.solverState.
+    IGL_INLINE Eigen::SparseMatrix<std::complex<double>> polyvector_energy_lhs(const PolyVectorData& pvData)
+    {
+        PolyVectorSolverState& state = pvData.solverState;
+        if (!state.operatorsValid){
+            state.smoothLhs = pvData.smoothMat.adjoint()*pvData.WSmooth*pvData.smoothMat;
+            if (pvData.roSyMat.rows()!=0)
+                state.roSyLhs = pvData.roSyMat.adjoint()*pvData.WRoSy*pvData.roSyMat;
+            else
+                state.roSyLhs.resize(0,0);
+            state.operatorsValid=true;
+        }
+        Eigen::SparseMatrix<std::complex<double>> energyLhs = state.smoothLhs * (pvData.wSmooth / pvData.totalSmoothWeight);
+        if (pvData.roSyMat.rows()!=0)
+            energyLhs=energyLhs+(pvData.wRoSy*state.roSyLhs)/pvData.totalRoSyWeight;
+        return energyLhs;
     }
 
 
     // Computes a polyvector field on the entire mesh, where precomputation has taken place.
+    // Repeated calls (e.g., after changing constraint values or weights and calling polyvector_precompute() again) reuse pvData.solverState where possible.
     // Inputs:
     //  PolyVectorData: The data structure which should have been initialized with polyvector_precompute()
     // Outputs:
@@ -273,18 +412,14 @@ namespace directional
         using namespace std;
         using namespace Eigen;
 
-        //forming total energy matrix;
-        SparseMatrix<complex<double>> totalUnreducedLhs =(pvData.smoothMat.adjoint()*pvData.WSmooth*pvData.smoothMat) * (pvData.wSmooth / pvData.totalSmoothWeight);
-        if (pvData.roSyMat.rows()!=0)
-            totalUnreducedLhs=totalUnreducedLhs+(pvData.wRoSy*pvData.roSyMat.adjoint()*pvData.WRoSy*pvData.roSyMat)/pvData.totalRoSyWeight;
-        if (pvData.alignMat.rows()!=0)
-            totalUnreducedLhs=totalUnreducedLhs+(pvData.alignMat.adjoint()*pvData.WAlign*pvData.alignMat)/pvData.totalConstrainedWeight;
-        VectorXcd totalUnreducedRhs= (pvData.alignMat.adjoint()*pvData.WAlign*pvData.alignRhs)/pvData.totalConstrainedWeight;
-
-        SparseMatrix<complex<double>> totalLhs = pvData.reducMat.adjoint()*totalUnreducedLhs*pvData.reducMat;
-        VectorXcd totalRhs = pvData.reducMat.adjoint()*(totalUnreducedRhs - totalUnreducedLhs*pvData.reducRhs);
+        PolyVectorSolverState& state = pvData.solverState;
         if (pvData.constSpaces.size() == 0)  //alignmat should be empty and the reduction matrix should be only sign symmetry, if applicable
         {
+            //forming total energy matrix, with the smoothness and rotational-symmetry parts cached in the solver state
+            SparseMatrix<complex<double>> totalUnreducedLhs = polyvector_energy_lhs(pvData);
+            if (pvData.alignMat.rows()!=0)
+                totalUnreducedLhs=totalUnreducedLhs+(pvData.alignMat.adjoint()*pvData.WAlign*pvData.alignMat)/pvData.totalConstrainedWeight;
+
             //using a matrix with only the first sizeT x sizeT block
             vector<Triplet<complex<double>>> X0LhsTriplets, X0MTriplets;
             SparseMatrix<complex<double>> X0Lhs, X0M;
@@ -307,7 +442,8 @@ namespace directional
             //Extracting first eigenvector
             Eigen::MatrixXcd U;
             Eigen::VectorXcd S;
-            complex_eigs(X0Lhs, X0M, 10, U, S);
+            bool converged = hermitian_eigs(X0Lhs, X0M, 1, U, S);
+            assert(converged && "polyvector_field(): the eigenvector of the unconstrained field did not converge");
             int smallestIndex; S.cwiseAbs().minCoeff(&smallestIndex);
 
             pvField.fieldType = fieldTypeEnum::POLYVECTOR_FIELD;
@@ -315,11 +451,135 @@ namespace directional
             intField.col(0)=U.col(smallestIndex);
             pvField.set_intrinsic_field(intField);
         } else { //just solving the system
-            SimplicialLDLT<SparseMatrix<complex<double>>> solver;
-            //solver.analyzePattern(totalLhs);   // for this step the numerical values of A are not used
-            solver.compute(totalLhs);
-            VectorXcd reducedDofs = solver.solve(totalRhs);
-            assert(solver.info() == Success);
+            VectorXcd totalRhs, reducedDofs;
+            std::function<void(const VectorXcd&, VectorXcd&)> solve;  //the second argument is the initial guess of the iterative solver
+            vector<VectorXcd> iterativeAddedConstSolves;  //iterative solutions are not kept, as they are not exact
+            vector<VectorXcd>& addedConstSolves = (pvData.iterativeSolver ? iterativeAddedConstSolves : state.addedConstSolves);
+
+            //for the iterative solver
+            const TangentBundle& tb = *pvField.tb;
+            vector<VectorXcd> blockTransports;
+            VectorXd smoothWeights;
+            SparseMatrix<complex<double>> totalLhs;
+            IncompleteCholesky<complex<double>> incompleteCholesky;
+            VectorXd jacobiDiagonal;
+            std::function<void(const VectorXcd&, VectorXcd&)> applyLhs, applyPrecond;
+            auto apply_unreduced = [&](const VectorXcd& u, VectorXcd& v){
+                v = VectorXcd::Zero(u.size());
+                for (int n=0;n<pvData.N;n++)
+                    connection_laplacian_apply(tb, blockTransports[n], smoothWeights, u.segment(n*pvData.sizeT, pvData.sizeT), v.segment(n*pvData.sizeT, pvData.sizeT));
+                if (pvData.roSyMat.rows()!=0)
+                    v += (pvData.wRoSy/pvData.totalRoSyWeight)*(pvData.roSyMat.adjoint()*(pvData.WRoSy*(pvData.roSyMat*u)));
+                if (pvData.alignMat.rows()!=0)
+                    v += (pvData.alignMat.adjoint()*(pvData.WAlign*(pvData.alignMat*u)))/pvData.totalConstrainedWeight;
+            };
+
+            if (!pvData.iterativeSolver){
+                //forming total energy matrix, with the smoothness and rotational-symmetry parts cached in the solver state
+                SparseMatrix<complex<double>> totalUnreducedLhs = polyvector_energy_lhs(pvData);
+                if (pvData.alignMat.rows()!=0)
+                    totalUnreducedLhs=totalUnreducedLhs+(pvData.alignMat.adjoint()*pvData.WAlign*pvData.alignMat)/pvData.totalConstrainedWeight;
+                VectorXcd totalUnreducedRhs= (pvData.alignMat.adjoint()*pvData.WAlign*pvData.alignRhs)/pvData.totalConstrainedWeight;
+
+                totalLhs = pvData.reducMat.adjoint()*totalUnreducedLhs*pvData.reducMat;
+                totalRhs = pvData.reducMat.adjoint()*(totalUnreducedRhs - totalUnreducedLhs*pvData.reducRhs);
+
+                //the symbolic analysis is only redone when the pattern changes, and the factorization only when the values change
+                totalLhs.makeCompressed();
+                state.factorize(totalLhs);
+                solve = [&](const VectorXcd& b, VectorXcd& x){
+                    x = state.solver.solve(b);
+                    assert(state.solver.info() == Success);
+                };
+            } else {
+                //the unreduced operator is applied without forming it: the smoothness of each coefficient block directly from the connection, and the diagonal
+                //rotational-symmetry and local alignment terms from their sparse operators. The reduced operator is reducMat^* (unreduced) reducMat.
+                blockTransports.resize(pvData.N);
+                for (int n=0;n<pvData.N;n++){
+                    blockTransports[n].resize(tb.adjSpaces.rows());
+                    for (int i=0;i<tb.adjSpaces.rows();i++)
+                        blockTransports[n](i) = pow(tb.connection(i),pvData.N-n);
+                }
+                smoothWeights = tb.connectionMass*(pvData.wSmooth/pvData.totalSmoothWeight);
+
+                VectorXcd unreducedLhsTimesRhs;
+                apply_unreduced(pvData.reducRhs, unreducedLhsTimesRhs);
+                totalRhs = pvData.reducMat.adjoint()*((pvData.alignMat.adjoint()*(pvData.WAlign*pvData.alignRhs))/pvData.totalConstrainedWeight - unreducedLhsTimesRhs);
+
+                if (pvData.preconditioner==preconditionerEnum::INCOMPLETE_CHOLESKY){
+                    //assembling the reduced system only (no fill-in beyond that of the incomplete factor)
+                    SparseMatrix<complex<double>> totalUnreducedLhs = polyvector_energy_lhs(pvData);
+                    if (pvData.alignMat.rows()!=0)
+                        totalUnreducedLhs=totalUnreducedLhs+(pvData.alignMat.adjoint()*pvData.WAlign*pvData.alignMat)/pvData.totalConstrainedWeight;
+                    totalLhs = pvData.reducMat.adjoint()*totalUnreducedLhs*pvData.reducMat;
+                    incompleteCholesky.compute(totalLhs);
+                    assert(incompleteCholesky.info() == Success);
+                    applyLhs = [&](const VectorXcd& x, VectorXcd& y){ y = totalLhs*x; };
+                    applyPrecond = [&](const VectorXcd& r, VectorXcd& z){ z = incompleteCholesky.solve(r); };
+                } else {
+                    //Jacobi, with the diagonal of the reduced operator from that of the unreduced one
+                    VectorXd unreducedDiagonal = VectorXd::Zero(pvData.N*pvData.sizeT);
+                    for (int n=0;n<pvData.N;n++)
+                        unreducedDiagonal.segment(n*pvData.sizeT, pvData.sizeT) = connection_laplacian_diagonal(tb, blockTransports[n], smoothWeights, pvData.sizeT);
+                    if (pvData.roSyMat.rows()!=0)
+                        unreducedDiagonal += (pvData.wRoSy/pvData.totalRoSyWeight)*SparseMatrix<complex<double>>(pvData.roSyMat.adjoint()*pvData.WRoSy*pvData.roSyMat).diagonal().real();
+                    if (pvData.alignMat.rows()!=0)
+                        unreducedDiagonal += SparseMatrix<complex<double>>(pvData.alignMat.adjoint()*pvData.WAlign*pvData.alignMat).diagonal().real()/pvData.totalConstrainedWeight;
+                    jacobiDiagonal = VectorXd::Zero(pvData.reducMat.cols());
+                    for (int k=0;k<pvData.reducMat.outerSize();k++)
+                        for (SparseMatrix<complex<double>>::InnerIterator it(pvData.reducMat,k); it; ++it)
+                            jacobiDiagonal(k)+=std::norm(it.value())*unreducedDiagonal(it.row());
+                    for (int k=0;k<jacobiDiagonal.size();k++)
+                        if (jacobiDiagonal(k)<=0.0)
+                            jacobiDiagonal(k)=1.0;
+                    applyLhs = [&](const VectorXcd& x, VectorXcd& y){
+                        VectorXcd v;
+                        apply_unreduced(pvData.reducMat*x, v);
+                        y = pvData.reducMat.adjoint()*v;
+                    };
+                    applyPrecond = [&](const VectorXcd& r, VectorXcd& z){ z = r.cwiseQuotient(jacobiDiagonal); };
+                }
+
+                solve = [&](const VectorXcd& b, VectorXcd& x){
+                    bool converged = conjugate_gradient(applyLhs, applyPrecond, b, x, pvData.iterativeTolerance, pvData.iterativeMaxIterations);
+                    assert(converged && "polyvector_field(): conjugate gradient did not converge");
+                };
+            }
+
+            reducedDofs = state.lastReducedDofs;  //warm-starting the iterative solver with the previous solution
+            solve(totalRhs, reducedDofs);
+            state.lastReducedDofs = reducedDofs;
+
+            //enforcing the added constraints C*x=d with the Schur complement of the KKT system: x = x0 - Z*lambda, with Z=A^-1*C^* and (C*Z)*lambda = C*x0-d.
+            //With the direct solver, Z is kept in the solver state, so an added constraint costs a single new solve as long as the factorization stays.
+            std::vector<int> activeAdded;
+            for (int i=0;i<pvData.addedConstRows.size();i++)
+                if (pvData.addedConstRows[i].nonZeros()!=0)
+                    activeAdded.push_back(i);
+            if (!activeAdded.empty()){
+                auto row_times = [](const SparseVector<complex<double>>& row, const VectorXcd& x){
+                    complex<double> result(0.0,0.0);
+                    for (SparseVector<complex<double>>::InnerIterator it(row); it; ++it)
+                        result+=it.value()*x(it.index());
+                    return result;
+                };
+                for (int i=addedConstSolves.size();i<pvData.addedConstRows.size();i++){
+                    addedConstSolves.push_back(VectorXcd());
+                    if (pvData.addedConstRows[i].nonZeros()!=0)
+                        solve(VectorXcd(pvData.addedConstRows[i]).conjugate(), addedConstSolves.back());
+                }
+                MatrixXcd schurMat(activeAdded.size(), activeAdded.size());
+                VectorXcd schurRhs(activeAdded.size());
+                for (int i=0;i<activeAdded.size();i++){
+                    for (int j=0;j<activeAdded.size();j++)
+                        schurMat(i,j) = row_times(pvData.addedConstRows[activeAdded[i]], addedConstSolves[activeAdded[j]]);
+                    schurRhs(i) = row_times(pvData.addedConstRows[activeAdded[i]], reducedDofs) - pvData.addedConstRhs[activeAdded[i]];
+                }
+                VectorXcd lambda = schurMat.fullPivLu().solve(schurRhs);
+                for (int i=0;i<activeAdded.size();i++)
+                    reducedDofs -= lambda(i)*addedConstSolves[activeAdded[i]];
+            }
+
             VectorXcd fullDofs = pvData.reducMat*reducedDofs+pvData.reducRhs;
             MatrixXcd intField(pvData.sizeT, pvData.N);
             for (int i=0;i<pvData.N;i++)
@@ -334,6 +594,238 @@ namespace directional
     }
 
 
+
+    // Computes the linear constraint of the added hard constraint constIndex (>= pvData.numReducedConstraints) on the reduced dofs of pvData: the constraint vector
+    // is a root of the polynomial of its tangent space. The row is left empty if earlier hard constraints already fix that space, as polyvector_precompute() would ignore it.
+    IGL_INLINE void polyvector_added_constraint_row(const TangentBundle& tb,
+                                                    const PolyVectorData& pvData,
+                                                    const int constIndex,
+                                                    Eigen::SparseVector<std::complex<double>>& constRow,
+                                                    std::complex<double>& constRhs)
+    {
+        using namespace std;
+        using namespace Eigen;
+
+        int realN = (pvData.signSymmetry ? pvData.N/2 : pvData.N);
+        realN = (pvData.wRoSy < 0.0 ? 1 : realN);
+        int jump = (pvData.signSymmetry ? 2 : 1);
+        jump = (pvData.wRoSy < 0.0 ? pvData.N : jump);
+
+        const int constSpace = pvData.constSpaces(constIndex);
+        constRow.resize(pvData.reducMat.cols());
+        constRow.setZero();
+        constRhs = complex<double>(0.0,0.0);
+        int numEarlierConstraints=0;
+        for (int i=0;i<constIndex;i++)
+            if ((pvData.constSpaces(i)==constSpace)&&(pvData.wAlignment(i)<0.0))
+                numEarlierConstraints++;
+        if (numEarlierConstraints>=realN)
+            return;  //overconstrained
+
+        VectorXi constSpaceVec(1); constSpaceVec(0)=constSpace;
+        MatrixXd constVectorIntrinsic = tb.project_to_intrinsic(constSpaceVec, pvData.constVectors.row(constIndex));
+        complex<double> constVectorComplexRaw = complex<double>(constVectorIntrinsic(0,0),constVectorIntrinsic(0,1));
+        complex<double> constVectorComplex = (pvData.signSymmetry ? constVectorComplexRaw*constVectorComplexRaw : constVectorComplexRaw);
+        constVectorComplex = (pvData.wRoSy < 0.0 ? pow(constVectorComplexRaw, pvData.N) : constVectorComplex);
+
+        //sum_j z^j*x_j = -z^realN on the unreduced coefficients x_j of the space, which are reducMat*dofs+reducRhs
+        VectorXcd zPowers(realN+1);
+        zPowers(0)=complex<double>(1.0,0.0);
+        for (int j=0;j<realN;j++)
+            zPowers(j+1)=zPowers(j)*constVectorComplex;
+        constRhs = -zPowers(realN);
+        for (int j=0;j<realN;j++)
+            constRhs -= zPowers(j)*pvData.reducRhs(j*jump*pvData.sizeT+constSpace);
+        for (int k=0;k<pvData.reducMat.outerSize();k++)
+            for (SparseMatrix<complex<double>>::InnerIterator it(pvData.reducMat,k); it; ++it){
+                if (it.row()%pvData.sizeT!=constSpace)
+                    continue;
+                int coeff = it.row()/pvData.sizeT;
+                if ((coeff%jump==0)&&(coeff/jump<realN))
+                    constRow.coeffRef(k)+=zPowers(coeff/jump)*it.value();
+            }
+    }
+
+
+    // Adds a hard constraint to a precomputed PolyVectorData without redoing the precomputation or the factorization: the next polyvector_field() enforces it
+    // on top of the current factorization, through a Schur complement of the size of the number of added constraints, which costs a single new solve per added constraint.
+    // polyvector_precompute() folds the added constraints into the system, which is worth calling when many accumulate.
+    // Input:
+    //  tb:             underlying tangent bundle
+    //  constSpace:     the tangent space to constrain
+    //  constVector:    1 x 3 extrinsic constraint vector
+    // Output:
+    //  pvField:        only touched when pvData had no constraints, in which case the full precomputation is done
+    //  pvData:         with the constraint appended to constSpaces, constVectors and wAlignment
+    IGL_INLINE void polyvector_add_constraint(const TangentBundle& tb,
+                                              const int constSpace,
+                                              const Eigen::RowVector3d& constVector,
+                                              directional::CartesianField& pvField,
+                                              PolyVectorData& pvData)
+    {
+        const int numConstraints = pvData.constSpaces.size();
+        pvData.constSpaces.conservativeResize(numConstraints+1);
+        pvData.constVectors.conservativeResize(numConstraints+1,3);
+        pvData.wAlignment.conservativeResize(numConstraints+1);
+        pvData.constSpaces(numConstraints) = constSpace;
+        pvData.constVectors.row(numConstraints) = constVector;
+        pvData.wAlignment(numConstraints) = -1.0;
+
+        if (pvData.numReducedConstraints==0){  //the unconstrained field is an eigenvector, and not a solution of the system
+            polyvector_precompute(tb, pvData.N, pvField, pvData);
+            return;
+        }
+
+        pvData.addedConstRows.push_back(Eigen::SparseVector<std::complex<double>>());
+        pvData.addedConstRhs.push_back(std::complex<double>());
+        polyvector_added_constraint_row(tb, pvData, numConstraints, pvData.addedConstRows.back(), pvData.addedConstRhs.back());
+    }
+
+
+    // Removes constraint constIndex from pvData. Constraints added by polyvector_add_constraint() are removed without any new factorization or solve;
+    // removing a constraint that was reduced by polyvector_precompute() (constIndex < pvData.numReducedConstraints) redoes the precomputation.
+    // Input:
+    //  tb:             underlying tangent bundle
+    //  constIndex:     index of the constraint in pvData.constSpaces
+    // Output:
+    //  pvField:        only touched when the precomputation is redone
+    //  pvData:         without the constraint
+    IGL_INLINE void polyvector_remove_constraint(const TangentBundle& tb,
+                                                 const int constIndex,
+                                                 directional::CartesianField& pvField,
+                                                 PolyVectorData& pvData)
+    {
+        const int numConstraints = pvData.constSpaces.size();
+        const int removedSpace = pvData.constSpaces(constIndex);
+        for (int i=constIndex;i<numConstraints-1;i++){
+            pvData.constSpaces(i) = pvData.constSpaces(i+1);
+            pvData.constVectors.row(i) = pvData.constVectors.row(i+1);
+            pvData.wAlignment(i) = pvData.wAlignment(i+1);
+        }
+        pvData.constSpaces.conservativeResize(numConstraints-1);
+        pvData.constVectors.conservativeResize(numConstraints-1,3);
+        pvData.wAlignment.conservativeResize(numConstraints-1);
+
+        if (constIndex<pvData.numReducedConstraints){
+            polyvector_precompute(tb, pvData.N, pvField, pvData);
+            return;
+        }
+
+        const int addedIndex = constIndex-pvData.numReducedConstraints;
+        std::vector<Eigen::VectorXcd>& addedConstSolves = pvData.solverState.addedConstSolves;
+        pvData.addedConstRows.erase(pvData.addedConstRows.begin()+addedIndex);
+        pvData.addedConstRhs.erase(pvData.addedConstRhs.begin()+addedIndex);
+        if (addedIndex<addedConstSolves.size())
+            addedConstSolves.erase(addedConstSolves.begin()+addedIndex);
+
+        //a later added constraint on the same space that was ignored as overconstraining may now apply
+        for (int i=addedIndex;i<pvData.addedConstRows.size();i++){
+            if ((pvData.constSpaces(pvData.numReducedConstraints+i)!=removedSpace)||(pvData.addedConstRows[i].nonZeros()!=0))
+                continue;
+            polyvector_added_constraint_row(tb, pvData, pvData.numReducedConstraints+i, pvData.addedConstRows[i], pvData.addedConstRhs[i]);
+            if ((pvData.addedConstRows[i].nonZeros()!=0)&&(i<addedConstSolves.size()))
+                addedConstSolves.resize(i);
+        }
+    }
+
+
+    // Computes a batch of polyvector fields that share the operators and the constraint pattern (constSpaces and wAlignment) of pvData, and differ only in the constraint vectors.
+    // When every constrained space has a single reduced degree of freedom (power fields, N=1, or N=2 with sign symmetry), the constraint values only enter the right-hand side:
+    // the system is then factorized once (reusing pvData.solverState) and solved for all configurations together as a block.
+    // Otherwise the values also enter the system matrix, and each configuration is factorized on its own.
+    // Inputs:
+    //  tb:                 underlying tangent bundle
+    //  pvData:             initialized with polyvector_precompute(), with at least one constraint (pvData.constVectors itself is not used)
+    //  constVectorsBatch:  #configurations list of #constSpaces x 3 constraint vectors
+    //  parallel:           whether to work on the configurations in parallel threads
+    // Outputs:
+    //  pvFields: #configurations POLYVECTOR_FIELD type cartesian field objects
+    IGL_INLINE void polyvector_fields(const TangentBundle& tb,
+                                      const PolyVectorData& pvData,
+                                      const std::vector<Eigen::MatrixXd>& constVectorsBatch,
+                                      std::vector<directional::CartesianField>& pvFields,
+                                      const bool parallel = true)
+    {
+        using namespace std;
+        using namespace Eigen;
+
+        const int numConfigs = constVectorsBatch.size();
+        pvFields.resize(numConfigs);
+        if (numConfigs==0)
+            return;
+        assert(pvData.constSpaces.size()!=0 && "polyvector_fields(): the configurations must have constraints");
+        assert(pvData.numReducedConstraints==pvData.constSpaces.size() && "polyvector_fields(): constraints added by polyvector_add_constraint() need polyvector_precompute()");
+        const size_t minParallel = (parallel ? 1 : std::numeric_limits<size_t>::max());
+
+        int realN = (pvData.signSymmetry ? pvData.N/2 : pvData.N);
+        realN = (pvData.wRoSy < 0.0 ? 1 : realN);
+
+        //the cache of the solver state is filled here, before being read by the threads
+        const SparseMatrix<complex<double>> energyLhs = polyvector_energy_lhs(pvData);
+
+        auto set_field = [&](const VectorXcd& fullDofs, directional::CartesianField& pvField){
+            MatrixXcd intField(pvData.sizeT, pvData.N);
+            for (int i=0;i<pvData.N;i++)
+                intField.col(i) = fullDofs.segment(i*pvData.sizeT,pvData.sizeT);
+            pvField.init(tb, fieldTypeEnum::POLYVECTOR_FIELD, pvData.N);
+            pvField.set_intrinsic_field(intField);
+        };
+
+        if (realN==1){
+            //shared system: the reduction and alignment matrices of pvData are those of every configuration
+            SparseMatrix<complex<double>> totalUnreducedLhs = energyLhs;
+            if (pvData.alignMat.rows()!=0)
+                totalUnreducedLhs=totalUnreducedLhs+(pvData.alignMat.adjoint()*pvData.WAlign*pvData.alignMat)/pvData.totalConstrainedWeight;
+            SparseMatrix<complex<double>> totalLhs = pvData.reducMat.adjoint()*totalUnreducedLhs*pvData.reducMat;
+            totalLhs.makeCompressed();
+            PolyVectorSolverState& state = pvData.solverState;
+            state.factorize(totalLhs);
+
+            MatrixXcd totalRhs(totalLhs.rows(), numConfigs);
+            vector<VectorXcd> reducRhsBatch(numConfigs);
+            igl::parallel_for(numConfigs, [&](const int c){
+                SparseMatrix<complex<double>> reducMat, alignMat, WAlign;
+                VectorXcd alignRhs;
+                double totalConstrainedWeight;
+                polyvector_constraint_operators(tb, pvData, constVectorsBatch[c], reducMat, reducRhsBatch[c], alignMat, WAlign, alignRhs, totalConstrainedWeight);
+                totalRhs.col(c) = pvData.reducMat.adjoint()*((pvData.alignMat.adjoint()*(pvData.WAlign*alignRhs))/totalConstrainedWeight - totalUnreducedLhs*reducRhsBatch[c]);
+            }, minParallel);
+
+            //block solves, with the columns split between the threads
+            const int numChunks = (parallel ? std::max(1, std::min(numConfigs, (int)std::thread::hardware_concurrency())) : 1);
+            MatrixXcd reducedDofs(totalLhs.rows(), numConfigs);
+            igl::parallel_for(numChunks, [&](const int chunk){
+                const int begin = (chunk*numConfigs)/numChunks;
+                const int end = ((chunk+1)*numConfigs)/numChunks;
+                reducedDofs.middleCols(begin, end-begin) = state.solver.solve(totalRhs.middleCols(begin, end-begin));
+            }, minParallel);
+
+            igl::parallel_for(numConfigs, [&](const int c){
+                set_field(pvData.reducMat*reducedDofs.col(c)+reducRhsBatch[c], pvFields[c]);
+            }, minParallel);
+        } else {
+            //the constraint values are in the system matrix, so each configuration has its own factorization
+            igl::parallel_for(numConfigs, [&](const int c){
+                SparseMatrix<complex<double>> reducMat, alignMat, WAlign;
+                VectorXcd reducRhs, alignRhs;
+                double totalConstrainedWeight;
+                polyvector_constraint_operators(tb, pvData, constVectorsBatch[c], reducMat, reducRhs, alignMat, WAlign, alignRhs, totalConstrainedWeight);
+                SparseMatrix<complex<double>> totalUnreducedLhs = energyLhs;
+                if (alignMat.rows()!=0)
+                    totalUnreducedLhs=totalUnreducedLhs+(alignMat.adjoint()*WAlign*alignMat)/totalConstrainedWeight;
+                VectorXcd totalUnreducedRhs = (alignMat.adjoint()*WAlign*alignRhs)/totalConstrainedWeight;
+
+                SparseMatrix<complex<double>> totalLhs = reducMat.adjoint()*totalUnreducedLhs*reducMat;
+                VectorXcd totalRhs = reducMat.adjoint()*(totalUnreducedRhs - totalUnreducedLhs*reducRhs);
+                SimplicialLDLT<SparseMatrix<complex<double>>> solver(totalLhs);
+                VectorXcd reducedDofs = solver.solve(totalRhs);
+                assert(solver.info() == Success);
+                set_field(reducMat*reducedDofs+reducRhs, pvFields[c]);
+            }, minParallel);
+        }
+    }
+
+
     // minimal version without auxiliary data
     IGL_INLINE void polyvector_field(const TangentBundle& tb,
                                      const Eigen::VectorXi& constSpaces,
@@ -363,6 +855,32 @@ namespace directional
     }
 
 
+    // minimal batched version without auxiliary data: the configurations share constSpaces and alignWeights, and differ in their constraint vectors
+    IGL_INLINE void polyvector_fields(const TangentBundle& tb,
+                                      const Eigen::VectorXi& constSpaces,
+                                      const std::vector<Eigen::MatrixXd>& constVectorsBatch,
+                                      const double smoothWeight,
+                                      const double roSyWeight,
+                                      const Eigen::VectorXd& alignWeights,
+                                      const int N,
+                                      std::vector<directional::CartesianField>& pvFields,
+                                      const bool parallel = true)
+    {
+        pvFields.clear();
+        if (constVectorsBatch.empty())
+            return;
+        PolyVectorData pvData;
+        pvData.constSpaces = constSpaces;
+        pvData.constVectors = constVectorsBatch[0];
+        pvData.wAlignment = alignWeights;
+        pvData.wSmooth = smoothWeight;
+        pvData.wRoSy = roSyWeight;
+        directional::CartesianField pvField;
+        polyvector_precompute(tb,N,pvField,pvData);
+        polyvector_fields(tb, pvData, constVectorsBatch, pvFields, parallel);
+    }
+
+
 //A version with default parameters (in which alignment is hard by default).
     IGL_INLINE void polyvector_field(const TangentBundle& tb,
                                      const Eigen::VectorXi& constSpaces,
@@ -9,11 +9,15 @@
 #define DIRECTIONAL_POLYVECTOR_TO_RAW_H
 
 #include <iostream>
+#include <limits>
+#include <algorithm>
+#include <vector>
 #include <Eigen/Geometry>
 #include <Eigen/Sparse>
 #include <Eigen/SparseCholesky>
 #include <Eigen/Eigenvalues>
 #include <igl/PI.h>
+#include <igl/parallel_for.h>
 #include <directional/TriMesh.h>
 #include <directional/CartesianField.h>
 
@@ -51,11 +55,12 @@ namespace directional {
             polyValue *= (evalPoint - roots(i));
     }
 
-    IGL_INLINE void polynomial_eval_from_roots(const Eigen::MatrixXcd &roots,
-                                               const Eigen::VectorXcd &evalPoints,
-                                               Eigen::VectorXcd &polyValues) {
+    template<typename Scalar>
+    IGL_INLINE void polynomial_eval_from_roots(const Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, Eigen::Dynamic> &roots,
+                                               const Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, 1> &evalPoints,
+                                               Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, 1> &polyValues) {
         assert(evalPoints.rows() == roots.rows());
-        polyValues = Eigen::VectorXcd::Constant(evalPoints.rows(), std::complex<double>(1.0, 0.0));
+        polyValues = Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, 1>::Constant(evalPoints.rows(), std::complex<Scalar>(1.0, 0.0));
         for (int i = 0; i < roots.cols(); i++)
             polyValues.array() *= (evalPoints - roots.col(i)).array();  //rowwise-product faster?;
 
@@ -74,11 +79,12 @@ namespace directional {
         polyValue += z;  //the biggest and unit power
     }
 
-    IGL_INLINE void polynomial_eval(const Eigen::MatrixXcd &coeffs,
-                                    const Eigen::VectorXcd &evalPoints,
-                                    Eigen::VectorXcd &polyValues) {
-        polyValues = Eigen::VectorXcd::Zero(coeffs.rows());
-        Eigen::VectorXcd z = Eigen::VectorXcd::Constant(coeffs.rows(), 1.0);
+    template<typename Scalar>
+    IGL_INLINE void polynomial_eval(const Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, Eigen::Dynamic> &coeffs,
+                                    const Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, 1> &evalPoints,
+                                    Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, 1> &polyValues) {
+        polyValues = Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, 1>::Zero(coeffs.rows());
+        Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, 1> z = Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, 1>::Constant(coeffs.rows(), 1.0);
         for (int i = 0; i < coeffs.cols(); i++) {
             polyValues.array() += coeffs.col(i).array() * z.array();
             z.array() *= evalPoints.array();
@@ -88,25 +94,177 @@ namespace directional {
     }
 
 
-    // Converts a field in PolyVector representation to raw represenation. This is done by the fixed-point Durand-Kerner method.
+    // Closed-form roots of the monic polynomial z^n + coeffs(n-1)*z^(n-1) + ... + coeffs(0) for n<=4 (quadratic formula, Cardano and Ferrari). Used as initial guesses for the
+    // Durand-Kerner iterations, which correct their round-off.
+    template<typename Complex, typename CoeffVector, typename RootVector>
+    IGL_INLINE void closed_form_monic_roots(const CoeffVector& coeffs,
+                                            RootVector& roots)
+    {
+        typedef typename Complex::value_type Scalar;
+        const int n = coeffs.size();
+        const Complex omega = std::exp(Complex(0, Scalar(2.0*igl::PI/3.0)));
+
+        //the two roots of z^2+b*z+c, without cancellation
+        auto quadratic_roots = [](const Complex& b, const Complex& c, Complex& r0, Complex& r1){
+            Complex disc = std::sqrt(b*b-Scalar(4)*c);
+            if (std::real(std::conj(b)*disc)<Scalar(0))
+                disc = -disc;
+            r0 = -(b+disc)/Scalar(2);
+            r1 = (r0==Complex(0) ? Complex(0) : c/r0);
+        };
+
+        //the three roots of z^3+a2*z^2+a1*z+a0, by Cardano's formula on the depressed cubic
+        auto cubic_roots = [&](const Complex& a2, const Complex& a1, const Complex& a0, Complex* r){
+            const Complex p = a1-a2*a2/Scalar(3);
+            const Complex q = Scalar(2)*a2*a2*a2/Scalar(27)-a2*a1/Scalar(3)+a0;
+            const Complex D = std::sqrt(q*q/Scalar(4)+p*p*p/Scalar(27));
+            Complex C = -q/Scalar(2)+D;
+            if (std::abs(-q/Scalar(2)-D)>std::abs(C))
+                C = -q/Scalar(2)-D;
+            const Complex u = (C==Complex(0) ? Complex(0) : std::pow(C, Scalar(1.0/3.0)));
+            Complex uk = u;
+            for (int k=0;k<3;k++){
+                r[k] = (u==Complex(0) ? Complex(0) : uk-p/(Scalar(3)*uk))-a2/Scalar(3);
+                uk*=omega;
+            }
+        };
+
+        if (n==1)
+            roots(0) = -coeffs(0);
+        else if (n==2)
+            quadratic_roots(coeffs(1), coeffs(0), roots(0), roots(1));
+        else if (n==3){
+            Complex r[3];
+            cubic_roots(coeffs(2), coeffs(1), coeffs(0), r);
+            for (int k=0;k<3;k++)
+                roots(k)=r[k];
+        } else if (n==4){
+            //Ferrari: the depressed quartic y^4+p*y^2+q*y+r, with z=y-a3/4, splits into two quadratics by a root m of its resolvent cubic
+            const Complex a3=coeffs(3), a2=coeffs(2), a1=coeffs(1), a0=coeffs(0);
+            const Complex p = a2-Scalar(3)*a3*a3/Scalar(8);
+            const Complex q = a1-a3*a2/Scalar(2)+a3*a3*a3/Scalar(8);
+            const Complex r = a0-a3*a1/Scalar(4)+a3*a3*a2/Scalar(16)-Scalar(3)*a3*a3*a3*a3/Scalar(256);
+            Complex m[3];
+            cubic_roots(p, p*p/Scalar(4)-r, -q*q/Scalar(8), m);
+            Complex mMax = m[0];
+            for (int k=1;k<3;k++)
+                if (std::abs(m[k])>std::abs(mMax))
+                    mMax = m[k];
+            Complex y[4];
+            if (mMax==Complex(0)){  //biquadratic
+                Complex y2[2];
+                quadratic_roots(p, r, y2[0], y2[1]);
+                y[0]=std::sqrt(y2[0]); y[1]=-y[0];
+                y[2]=std::sqrt(y2[1]); y[3]=-y[2];
+            } else {
+                const Complex s = std::sqrt(Scalar(2)*mMax);
+                quadratic_roots(-s, p/Scalar(2)+mMax+q/(Scalar(2)*s), y[0], y[1]);
+                quadratic_roots(s, p/Scalar(2)+mMax-q/(Scalar(2)*s), y[2], y[3]);
+            }
+            for (int k=0;k<4;k++)
+                roots(k) = y[k]-a3/Scalar(4);
+        }
+    }
+
+
+    // The roots of the monic polynomial z^n + coeffs(n-1)*z^(n-1) + ... + coeffs(0) of a single tangent space, by (Gauss-Seidel) Durand-Kerner iterations that stop
+    // once |p(root)|<tolerance for all roots. With a compile-time degree n all temporaries are fixed-size, so that the complex arithmetic is unrolled and vectorized.
+    // Degrees up to 4 start from the closed-form roots, which usually leaves nothing or a single iteration to do.
+    // returns false if it did not converge within maxIterations sweeps.
+    template<typename Scalar, int n>
+    IGL_INLINE bool monic_polynomial_roots(const Eigen::Matrix<std::complex<Scalar>, n, 1>& coeffs,
+                                           Eigen::Matrix<std::complex<Scalar>, n, 1>& roots,
+                                           const Scalar tolerance,
+                                           const int maxIterations = 1000)
+    {
+        typedef std::complex<Scalar> Complex;
+        const int degree = coeffs.size();
+        roots.resize(degree);
+
+        if (degree<=4)
+            closed_form_monic_roots<Complex>(coeffs, roots);
+        else {
+            roots(0) = std::pow(-coeffs(0), Scalar(1.0/(double)degree));
+            if (std::abs(roots(0))<tolerance)
+                roots(0) = Complex(0.4, 0.9);  //the usual Durand-Kerner start, as the n-th roots of zero coincide
+            const Complex rotation = std::exp(Complex(0, Scalar(2.0*igl::PI/(double)degree)));
+            for (int i=1;i<degree;i++)
+                roots(i) = roots(i-1)*rotation;
+        }
+
+        for (int iteration=0;iteration<=maxIterations;iteration++){
+            Scalar maxError = 0;
+            for (int k=0;k<degree;k++){
+                //Horner evaluation of the monic polynomial
+                Complex numerator(1,0);
+                for (int i=degree-1;i>=0;i--)
+                    numerator = numerator*roots(k)+coeffs(i);
+                maxError = std::max(maxError, std::abs(numerator));
+                if (iteration==0)
+                    continue;  //the first sweep only checks the initial roots
+
+                Complex denominator(1,0);
+                for (int j=0;j<degree;j++)
+                    if (j!=k)
+                        denominator*=(roots(k)-roots(j));
+                if (denominator!=Complex(0))
+                    roots(k) -= numerator/denominator;
+            }
+            if (maxError<=tolerance)
+                return true;
+        }
+        return false;
+    }
+
+
+    // polyvector_to_raw() on the tangent spaces in parallel, with the compile-time degree n (or Eigen::Dynamic).
+    template<typename Scalar, int n>
+    IGL_INLINE bool polyvector_to_raw_spaces(const Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, Eigen::Dynamic>& actualPVField,
+                                             const bool signSymmetry,
+                                             const Scalar tolerance,
+                                             Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, Eigen::Dynamic>& roots)
+    {
+        typedef std::complex<Scalar> Complex;
+        const int actualN = actualPVField.cols();
+        roots.resize(actualPVField.rows(), actualN);
+        std::vector<char> converged(actualPVField.rows(), 1);
+        igl::parallel_for(actualPVField.rows(), [&](const int f){
+            Eigen::Matrix<Complex, n, 1> coeffs = actualPVField.row(f).transpose();
+            Eigen::Matrix<Complex, n, 1> spaceRoots(actualN);
+            converged[f] = monic_polynomial_roots<Scalar, n>(coeffs, spaceRoots, tolerance);
+            if (signSymmetry)
+                spaceRoots = spaceRoots.cwiseSqrt();
+            std::sort(spaceRoots.data(), spaceRoots.data() + actualN, [](const Complex& a, const Complex& b) { return arg(a) < arg(b); });
+            roots.row(f) = spaceRoots.transpose();
+        }, 1000);
+        return std::find(converged.begin(), converged.end(), 0)==converged.end();
+    }
+
+
+    // Converts a field in PolyVector representation to raw represenation. This is done by the fixed-point Durand-Kerner method, for each tangent space separately
+    // (in parallel, and with fixed-size arithmetic for the common degrees), starting from the closed-form roots when there are at most 4 of them.
     // Input:
     //  pvField:    a POLYVECTOR_FIELD type cartesian field object
     //  signSymmetry: if the field is sign-symmetric (so comprising line-fields). Then all odd PV coefficients are zero.
-    //  rootTolerance:  the numerical tolerance for the root computation.
+    //  rootTolerance:  the numerical tolerance for the root computation (never tighter than what Scalar can resolve).
     //
     // Output:
     //  roots:              #TangentSpaces by N complex matrix with all N roots of the PolyVectors in order
     //    returns true if succeeded
-    IGL_INLINE bool polyvector_to_raw(const Eigen::MatrixXd& pvField,
+    template<typename Scalar>
+    IGL_INLINE bool polyvector_to_raw(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& pvField,
                                       const int N,
-                                      Eigen::MatrixXcd &roots,
+                                      Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, Eigen::Dynamic> &roots,
                                       bool signSymmetry = true,
                                       const double rootTolerance = 1e-8) {
         using namespace std;
         using namespace Eigen;
+        typedef std::complex<Scalar> Complex;
+        typedef Eigen::Matrix<Complex, Eigen::Dynamic, Eigen::Dynamic> MatrixXcs;
 
+        const Scalar tolerance = std::max((Scalar)rootTolerance, Scalar(100)*std::numeric_limits<Scalar>::epsilon());
 
-        MatrixXcd actualPVField;
+        MatrixXcs actualPVField;
         int actualN;
         if (N % 2 != 0) signSymmetry = false;  //by definition
         if (signSymmetry) {
@@ -125,50 +283,23 @@ namespace directional {
             actualN = N;
         }
 
-        roots.resize(actualPVField.rows(), actualN);
-        roots.col(0).array() = (-actualPVField.col(0).array()).pow(1.0 / (double) actualN);
-        for (int i = 1; i < actualN; i++)
-            roots.col(i).array() =
-                    roots.col(i - 1).array() * std::exp(std::complex<double>(0, 2.0 * igl::PI / (double) actualN));
-
-        MatrixXd rootError = MatrixXd::Constant(actualPVField.rows(), actualN, 1000.0);
-        double maxError = 1000.0;
-        int currRoot = 0;
-        MatrixXcd mostRoots(actualPVField.rows(), actualN - 1);
-        int maxIterations = 1000;
-        int currIteration = 0;
-        do {
-            mostRoots.block(0, 0, mostRoots.rows(), currRoot) = roots.block(0, 0, roots.rows(), currRoot);
-            mostRoots.block(0, currRoot, mostRoots.rows(), actualN - currRoot - 1) = roots.block(0, currRoot + 1,
-                                                                                                 roots.rows(),
-                                                                                                 actualN - currRoot -
-                                                                                                 1);
-            VectorXcd numerator;
-            polynomial_eval(actualPVField, roots.col(currRoot), numerator);
-            VectorXcd denominator;
-            polynomial_eval_from_roots(mostRoots, roots.col(currRoot), denominator);
-            roots.col(currRoot).array() -= numerator.array() / denominator.array();
-            rootError.col(currRoot) = numerator.cwiseAbs();
-            maxError = rootError.lpNorm<Infinity>();  //optimize by only the relevant column?
-            currRoot = (currRoot + 1) % actualN;
-            currIteration++;
-        } while ((maxError > rootTolerance) && (currIteration < maxIterations));
-
-        if (currIteration >= maxIterations)
-            return false;
-
-        if (signSymmetry)
-            roots = roots.cwiseSqrt();
-
-        for (int f = 0; f < roots.rows(); f++) {
-            RowVectorXcd rowRoots = roots.row(f);
-            std::sort(rowRoots.data(), rowRoots.data() + rowRoots.size(),
-                      [](std::complex<double> a, std::complex<double> b) { return arg(a) < arg(b); });
-            roots.row(f) = rowRoots;
+        bool converged;
+        switch (actualN){
+            case 1: converged = polyvector_to_raw_spaces<Scalar, 1>(actualPVField, signSymmetry, tolerance, roots); break;
+            case 2: converged = polyvector_to_raw_spaces<Scalar, 2>(actualPVField, signSymmetry, tolerance, roots); break;
+            case 3: converged = polyvector_to_raw_spaces<Scalar, 3>(actualPVField, signSymmetry, tolerance, roots); break;
+            case 4: converged = polyvector_to_raw_spaces<Scalar, 4>(actualPVField, signSymmetry, tolerance, roots); break;
+            case 5: converged = polyvector_to_raw_spaces<Scalar, 5>(actualPVField, signSymmetry, tolerance, roots); break;
+            case 6: converged = polyvector_to_raw_spaces<Scalar, 6>(actualPVField, signSymmetry, tolerance, roots); break;
+            case 7: converged = polyvector_to_raw_spaces<Scalar, 7>(actualPVField, signSymmetry, tolerance, roots); break;
+            case 8: converged = polyvector_to_raw_spaces<Scalar, 8>(actualPVField, signSymmetry, tolerance, roots); break;
+            default: converged = polyvector_to_raw_spaces<Scalar, Eigen::Dynamic>(actualPVField, signSymmetry, tolerance, roots);
         }
+        if (!converged)
+            return false;
 
         if (signSymmetry) {
-            MatrixXcd actualRoots(roots.rows(), 2 * roots.cols());
+            MatrixXcs actualRoots(roots.rows(), 2 * roots.cols());
             actualRoots << roots, -roots;
             roots = actualRoots;
         }
@@ -177,13 +308,14 @@ namespace directional {
     }
 
 
-    IGL_INLINE bool polyvector_to_raw(const directional::CartesianField &pvField,
-                                      directional::CartesianField &rawField,
+    template<typename Scalar>
+    IGL_INLINE bool polyvector_to_raw(const directional::CartesianFieldT<Scalar> &pvField,
+                                      directional::CartesianFieldT<Scalar> &rawField,
                                       bool signSymmetry = true,
                                       const double rootTolerance = 1e-8) {
 
         rawField.init(*(pvField.tb), fieldTypeEnum::RAW_FIELD, pvField.N);
-        Eigen::MatrixXcd intField;
+        Eigen::Matrix<std::complex<Scalar>, Eigen::Dynamic, Eigen::Dynamic> intField;
         if (pvField.N % 2 != 0) signSymmetry = false;  //by definition
         polyvector_to_raw(pvField.intField, pvField.N, intField, signSymmetry, rootTolerance);
         rawField.set_intrinsic_field(intField);
@@ -9,8 +9,14 @@
 #define DIRECTIONAL_POWER_FIELD_H
 
 #include <iostream>
+#include <vector>
+#include <thread>
+#include <limits>
+#include <complex>
 #include <Eigen/Geometry>
 #include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <igl/parallel_for.h>
 #include <directional/polyvector_field.h>
 #include <directional/TangentBundle.h>
 #include <directional/CartesianField.h>
@@ -18,8 +24,182 @@
 
 namespace directional
 {
+    // Assembles the power-field system directly on the #T single complex coefficients: hard-constrained spaces are eliminated, and the constraint values only enter
+    // through constMat, so that one system serves any constraint vectors with the same pattern. The solution is x=lhs^-1*constMat*constValues at the free spaces, and
+    // constValues(fixedConsts(i)) at the others, where constValues(j)=-z^N for the complex intrinsic constraint vector z (the same representation as the polyvector coefficients).
+    // Input:
+    //  tb:             underlying tangent bundle.
+    //  constSpaces:    the constrained tangent spaces.
+    //  alignWeights:   #constSpaces x 1 soft weights for alignment (negative values = fixed faces).
+    //  N:              The degree of the field.
+    // Output:
+    //  lhs:            #free x #free Hermitian system matrix.
+    //  constMat:       #free x #constSpaces map from the constraint values to the right-hand side.
+    //  freeIndices:    #T x 1 index of each tangent space in the system, or -1 when it is fixed.
+    //  fixedConsts:    #T x 1 the constraint fixing each tangent space, or -1 when it is free.
+    IGL_INLINE void power_field_system(const TangentBundle& tb,
+                                       const Eigen::VectorXi& constSpaces,
+                                       const Eigen::VectorXd& alignWeights,
+                                       const int N,
+                                       Eigen::SparseMatrix<std::complex<double>>& lhs,
+                                       Eigen::SparseMatrix<std::complex<double>>& constMat,
+                                       Eigen::VectorXi& freeIndices,
+                                       Eigen::VectorXi& fixedConsts)
+    {
+        using namespace std;
+        using namespace Eigen;
+
+        const int sizeT = tb.sources.rows();
+        fixedConsts = VectorXi::Constant(sizeT, -1);
+        for (int i=0;i<constSpaces.size();i++)
+            if ((alignWeights(i)<0.0)&&(fixedConsts(constSpaces(i))==-1))
+                fixedConsts(constSpaces(i)) = i;  //further hard constraints on the same space are ignored
+
+        freeIndices.resize(sizeT);
+        int numFree=0;
+        for (int i=0;i<sizeT;i++)
+            freeIndices(i) = (fixedConsts(i)==-1 ? numFree++ : -1);
+
+        //smoothness: |conn^N*x(adjSpaces(i,0))-x(adjSpaces(i,1))|^2 per inner edge
+        vector<Triplet<complex<double>>> lhsTriplets, constTriplets;
+        const double totalSmoothWeight = tb.connectionMass.sum();
+        for (int i=0;i<tb.adjSpaces.rows();i++){
+            const int s0=tb.adjSpaces(i,0), s1=tb.adjSpaces(i,1);
+            if ((s0==-1)||(s1==-1))
+                continue;  //boundary edge
+
+            const complex<double> c = pow(tb.connection(i), N);
+            const double w = tb.connectionMass(i)/totalSmoothWeight;
+            const int spaces[2] = {s0, s1};
+            const complex<double> d[2] = {c, complex<double>(-1.0,0.0)};
+            for (int a=0;a<2;a++){
+                if (freeIndices(spaces[a])==-1)
+                    continue;
+                for (int b=0;b<2;b++){
+                    const complex<double> value = w*conj(d[a])*d[b];
+                    if (freeIndices(spaces[b])!=-1)
+                        lhsTriplets.push_back(Triplet<complex<double>>(freeIndices(spaces[a]), freeIndices(spaces[b]), value));
+                    else
+                        constTriplets.push_back(Triplet<complex<double>>(freeIndices(spaces[a]), fixedConsts(spaces[b]), -value));
+                }
+            }
+        }
+
+        //soft alignment: w*|x(constSpace)-constValue|^2 per constraint on a free space
+        double totalConstrainedWeight=0.0;
+        for (int i=0;i<constSpaces.size();i++)
+            if (alignWeights(i)>=0.0)
+                totalConstrainedWeight+=tb.tangentSpaceMass(constSpaces(i));
+        if (totalConstrainedWeight==0.0)
+            totalConstrainedWeight=1.0;
+        for (int i=0;i<constSpaces.size();i++){
+            if ((alignWeights(i)<0.0)||(freeIndices(constSpaces(i))==-1))
+                continue;
+            const double w = alignWeights(i)*tb.tangentSpaceMass(constSpaces(i))/totalConstrainedWeight;
+            lhsTriplets.push_back(Triplet<complex<double>>(freeIndices(constSpaces(i)), freeIndices(constSpaces(i)), w));
+            constTriplets.push_back(Triplet<complex<double>>(freeIndices(constSpaces(i)), i, w));
+        }
+
+        lhs.resize(numFree, numFree);
+        lhs.setFromTriplets(lhsTriplets.begin(), lhsTriplets.end());
+        constMat.resize(numFree, constSpaces.size());
+        constMat.setFromTriplets(constTriplets.begin(), constTriplets.end());
+    }
+
+
+    // The constraint values of power_field_system() for the given constraint vectors.
+    IGL_INLINE Eigen::VectorXcd power_field_constraint_values(const TangentBundle& tb,
+                                                              const Eigen::VectorXi& constSpaces,
+                                                              const Eigen::MatrixXd& constVectors,
+                                                              const int N)
+    {
+        Eigen::MatrixXd constVectorsIntrinsic = tb.project_to_intrinsic(constSpaces, constVectors);
+        Eigen::VectorXcd constValues(constSpaces.size());
+        for (int i=0;i<constSpaces.size();i++)
+            constValues(i) = -pow(std::complex<double>(constVectorsIntrinsic(i,0), constVectorsIntrinsic(i,1)), N);
+        return constValues;
+    }
+
+
+    // Computes a batch of power fields that share the constrained faces and alignment weights, and differ in their constraint vectors.
+    // The system of power_field_system() is factorized once and solved for all configurations together as a block.
+    // Input:
+    //  tb: underlying tangent bundle.
+    //  constSpaces: the list of constrained faces, as in power_field().
+    //  constVectorsBatch: #configurations list of #constSpaces x 3 constraint vectors.
+    //  alignWeights: #constFaces x 1 soft weights for alignment (negative values = fixed faces).
+    //  N: The degree of the field.
+    //  parallel: whether to solve in parallel threads.
+    // Output:
+    //  fields: #configurations cartesian power-field objects.
+    IGL_INLINE void power_fields(const TangentBundle& tb,
+                                 const Eigen::VectorXi& constSpaces,
+                                 const std::vector<Eigen::MatrixXd>& constVectorsBatch,
+                                 const Eigen::VectorXd& alignWeights,
+                                 const int N,
+                                 std::vector<directional::CartesianField>& fields,
+                                 const bool parallel = true)
+    {
+        using namespace std;
+        using namespace Eigen;
+
+        const int numConfigs = constVectorsBatch.size();
+        fields.resize(numConfigs);
+        if (numConfigs==0)
+            return;
+        const size_t minParallel = (parallel ? 1 : std::numeric_limits<size_t>::max());
+
+        //in case there are no constraints, using a single fixed space, just to offset the smoothest field rotation null-space
+        VectorXi actualConstSpaces = constSpaces;
+        VectorXd actualAlignWeights = alignWeights;
+        vector<MatrixXd> defaultConstVectors;
+        if (constSpaces.size()==0){
+            actualConstSpaces = VectorXi::Zero(1);
+            actualAlignWeights = VectorXd::Constant(1,-1.0);
+            RowVector2d intConstVector; intConstVector<<1.0,0.0;
+            defaultConstVectors.assign(numConfigs, tb.project_to_extrinsic(actualConstSpaces, intConstVector));
+        }
+        const vector<MatrixXd>& actualConstVectorsBatch = (constSpaces.size()==0 ? defaultConstVectors : constVectorsBatch);
+
+        SparseMatrix<complex<double>> lhs, constMat;
+        VectorXi freeIndices, fixedConsts;
+        power_field_system(tb, actualConstSpaces, actualAlignWeights, N, lhs, constMat, freeIndices, fixedConsts);
+
+        MatrixXcd constValues(actualConstSpaces.size(), numConfigs);
+        igl::parallel_for(numConfigs, [&](const int c){
+            constValues.col(c) = power_field_constraint_values(tb, actualConstSpaces, actualConstVectorsBatch[c], N);
+        }, minParallel);
+
+        MatrixXcd freeValues(lhs.rows(), numConfigs);
+        if (lhs.rows()!=0){
+            SimplicialLDLT<SparseMatrix<complex<double>>> solver(lhs);
+            assert(solver.info() == Success);
+            MatrixXcd rhs = constMat*constValues;
+            //block solves, with the columns split between the threads
+            const int numChunks = (parallel ? std::max(1, std::min(numConfigs, (int)std::thread::hardware_concurrency())) : 1);
+            igl::parallel_for(numChunks, [&](const int chunk){
+                const int begin = (chunk*numConfigs)/numChunks;
+                const int end = ((chunk+1)*numConfigs)/numChunks;
+                freeValues.middleCols(begin, end-begin) = solver.solve(rhs.middleCols(begin, end-begin));
+            }, minParallel);
+        }
+
+        igl::parallel_for(numConfigs, [&](const int c){
+            MatrixXd intField(freeIndices.size(), 2);
+            for (int i=0;i<freeIndices.size();i++){
+                complex<double> value = (freeIndices(i)!=-1 ? freeValues(freeIndices(i),c) : constValues(fixedConsts(i),c));
+                intField(i,0) = value.real();
+                intField(i,1) = value.imag();
+            }
+            fields[c].init(tb, fieldTypeEnum::POWER_FIELD, N);
+            fields[c].set_intrinsic_field(intField);
+        }, minParallel);
+    }
+
+
     // Computes a power field on the entire mesh from given values at the prescribed indices.
-    // If no constraints are given the lowest-eigenvalue (of smoothness energy) field will be returned.
+    // If no constraints are given, the first tangent space is fixed to the first basis vector, to offset the rotation null-space of the smoothest field.
+    // The system is assembled directly on the single power coefficient of each tangent space (see power_field_system()).
     // Input:
     //  tb: underlying tangent bundle.
     //  constFaces: the faces on which the polyvector is prescribed. If a face is repeated and the alignment is hard then all but the first vector in the face will be ignored.
@@ -35,13 +215,9 @@ namespace directional
                                 const int N,
                                 directional::CartesianField& field)
     {
-        //TODO: have the field be initialized here
-        polyvector_field(tb,constSpaces,constVectors,1.0, -1.0, alignWeights, N,field);
-        field.fieldType = fieldTypeEnum::POWER_FIELD;
-        //getting rid of the redundant zeros, in case they were allocated.
-        field.intField.conservativeResize(field.intField.rows(),2);
-        field.extField.conservativeResize(field.extField.rows(),3);
-        //powerField=-pvField.col(0);  //powerfield is represented positively
+        std::vector<directional::CartesianField> fields;
+        power_fields(tb, constSpaces, std::vector<Eigen::MatrixXd>(1, constVectors), alignWeights, N, fields, false);
+        field = fields[0];
     }
 }
 
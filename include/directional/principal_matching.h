@@ -9,77 +9,135 @@
 
 #include <vector>
 #include <cmath>
+#include <limits>
+#include <algorithm>
 #include <Eigen/Core>
 #include <igl/igl_inline.h>
+#include <igl/parallel_for.h>
 #include <directional/effort_to_indices.h>
 #include <directional/TangentBundle.h>
 
 namespace directional
 {
-    // Takes a field in raw form and computes both the principal effort and the consequent principal matching on every edge.
-    // Important: if the Raw field in not CCW ordered, the result is meaningless.
-    // The input and output are both a RAW_FIELD type cartesian field, in which the matching, effort, and singularities are set.
-    IGL_INLINE void principal_matching(directional::CartesianField& field)
+    // The principal effort and matching of the adjacencies [begin,end) of a raw field (see principal_matching() below), for a compile-time degree N or Eigen::Dynamic.
+    // With a fixed N the vectors of both tangent spaces live in fixed-size arrays. The smallest rotation is found by comparing cosines (dot products over the lengths)
+    // rather than angles, and the 2*PI wraps of the summed rotation angles are counted from the half-planes of the partial products, so that the effort is the only arg().
+    template<typename Scalar, int N>
+    IGL_INLINE void principal_matching_kernel(directional::CartesianFieldT<Scalar>& field,
+                                              const int begin,
+                                              const int end)
     {
-
-        typedef std::complex<double> Complex;
-        using namespace Eigen;
+        typedef std::complex<Scalar> Complex;
         using namespace std;
 
-        field.matching.conservativeResize(field.tb->adjSpaces.rows());
-        field.matching.setConstant(-1);
-
-        field.effort = VectorXd::Zero(field.tb->adjSpaces.rows());
-        for (int i = 0; i < field.tb->adjSpaces.rows(); i++) {
-            if (field.tb->adjSpaces(i, 0) == -1 || field.tb->adjSpaces(i, 1) == -1)
+        Eigen::Matrix<Complex, N, 1> transVecs, vecs;
+        transVecs.resize(field.N);
+        vecs.resize(field.N);
+        for (int i = begin; i < end; i++) {
+            const int s0 = field.tb->adjSpaces(i, 0), s1 = field.tb->adjSpaces(i, 1);
+            if (s0 == -1 || s1 == -1)
                 continue;
 
-            double minRotAngle=10000.0;
-            int indexMinFromZero=0;
+            const Complex connection = field.tb->connection(i);
+            for (int j = 0; j < field.N; j++) {
+                transVecs(j) = Complex(field.intField(s0, 2 * j), field.intField(s0, 2 * j + 1))*connection;
+                vecs(j) = Complex(field.intField(s1, 2 * j), field.intField(s1, 2 * j + 1));
+            }
 
-            //computing some effort and the extracting principal one
-            Complex freeCoeff(1.0,0.0);
-            //finding where the 0 vector in EF(i,0) goes to with smallest rotation angle in EF(i,1), computing the effort, and then adjusting the matching to have principal effort.
-            RowVector2d vec0f = field.intField.block(field.tb->adjSpaces(i, 0), 0, 1, 2);
-            Complex vec0fc = Complex(vec0f(0), vec0f(1));
-            Complex transvec0fc = vec0fc*field.tb->connection(i);
+            //finding where the 0 vector in EF(i,0) goes to with smallest rotation angle in EF(i,1), i.e., the one with the largest cosine
+            int indexMinFromZero=0;
+            Scalar maxCos=-2.0;
             for (int j = 0; j < field.N; j++) {
-                RowVector2d vecjf = field.intField.block(field.tb->adjSpaces(i, 0), 2 * j, 1, 2);
-                Complex vecjfc = Complex(vecjf(0),vecjf(1));
-                RowVector2d vecjg = field.intField.block(field.tb->adjSpaces(i, 1), 2 * j, 1, 2);
-                Complex vecjgc = Complex(vecjg(0),vecjg(1));
-                Complex transvecjfc = vecjfc*field.tb->connection(i);
-                freeCoeff *= (vecjgc / transvecjfc);
-                double currRotAngle =arg(vecjgc / transvec0fc);
-                if (abs(currRotAngle)<abs(minRotAngle)){
+                const Complex rotation = vecs(j)*conj(transVecs(0));
+                const Scalar currCos = (rotation==Complex(0.0) ? Scalar(1.0) : rotation.real()/sqrt(norm(rotation)));
+                if (currCos>maxCos){
                     indexMinFromZero=j;
-                    minRotAngle=currRotAngle;
+                    maxCos=currCos;
                 }
-
-                //taking principal effort
-
             }
-            field.effort(i) = arg(freeCoeff);
 
-            //finding the matching that implements effort(i)
-            //This is still not perfect
-            double currEffort=0;
+            //the effort is the arg of the product of the rotations. The sum of their individual angles for indexMinFromZero exceeds it by 2*PI times the number of times
+            //the partial products cross the negative real axis, which is the difference between indexMinFromZero and the matching that implements the principal effort.
+            Complex freeCoeff(1.0,0.0);
+            int wraps=0;
             for (int j = 0; j < field.N; j++) {
-                RowVector2d vecjf = field.intField.block(field.tb->adjSpaces(i, 0), 2*j, 1, 2);
-                Complex vecjfc = Complex(vecjf(0), vecjf(1));
-                RowVector2d vecjg = field.intField.block(field.tb->adjSpaces(i, 1), 2 *((j+indexMinFromZero+field.N)%field.N), 1, 2);
-                Complex vecjgc = Complex(vecjg(0), vecjg(1));
-                Complex transvecjfc = vecjfc*field.tb->connection(i);
-                currEffort+= arg(vecjgc / transvecjfc);
+                const Complex rotation = vecs((j+indexMinFromZero)%field.N)*conj(transVecs(j));
+                const Complex nextCoeff = freeCoeff*rotation;
+                if ((freeCoeff.imag()>=0.0)&&(rotation.imag()>=0.0)&&(nextCoeff.imag()<0.0))
+                    wraps++;
+                else if ((freeCoeff.imag()<0.0)&&(rotation.imag()<0.0)&&(nextCoeff.imag()>=0.0))
+                    wraps--;
+                freeCoeff=nextCoeff;
             }
-
-            field.matching(i)=indexMinFromZero-round((currEffort-field.effort(i))/(2.0*igl::PI));
+            field.effort(i) = arg(freeCoeff);
+            field.matching(i)=indexMinFromZero-wraps;
         }
+    }
+
+
+    // Takes a field in raw form and computes both the principal effort and the consequent principal matching on every edge.
+    // Important: if the Raw field in not CCW ordered, the result is meaningless.
+    // The input and output are both a RAW_FIELD type cartesian field, in which the matching, effort, and singularities are set.
+    // The common degrees (N=1,2,4,6) use fixed-size kernels, and the rest the dynamic one. Every adjacency only reads its own tangent spaces and writes its own
+    // matching and effort, so the adjacencies are processed in parallel blocks, with an output that does not depend on the number of threads.
+    template<typename Scalar>
+    IGL_INLINE void principal_matching(directional::CartesianFieldT<Scalar>& field,
+                                       const bool parallel = true)
+    {
+        using namespace Eigen;
+
+        field.matching.conservativeResize(field.tb->adjSpaces.rows());
+        field.matching.setConstant(-1);
+
+        field.effort = Matrix<Scalar, Dynamic, 1>::Zero(field.tb->adjSpaces.rows());
+        const int blockSize = 1024;
+        const int numBlocks = (field.tb->adjSpaces.rows()+blockSize-1)/blockSize;
+        igl::parallel_for(numBlocks, [&](const int b){
+            const int begin = b*blockSize;
+            const int end = std::min(begin+blockSize, (int)field.tb->adjSpaces.rows());
+            switch (field.N){
+                case 1: principal_matching_kernel<Scalar, 1>(field, begin, end); break;
+                case 2: principal_matching_kernel<Scalar, 2>(field, begin, end); break;
+                case 4: principal_matching_kernel<Scalar, 4>(field, begin, end); break;
+                case 6: principal_matching_kernel<Scalar, 6>(field, begin, end); break;
+                default: principal_matching_kernel<Scalar, Dynamic>(field, begin, end);
+            }
+        }, (parallel ? 2 : std::numeric_limits<size_t>::max()));
 
         //Getting final singularities and their indices
         effort_to_indices(field);
 
     }
+
+
+    // Incremental version of principal_matching() above, for a field that changed only around a few adjacencies (e.g., after an interactive edit of some tangent spaces):
+    // only the matching and effort of changedAdjacencies are recomputed, and the singularities are updated by the incremental effort_to_indices(), all in time
+    // proportional to the edit. The field must have been matched before (its effort and singularities are up to date for the other adjacencies).
+    // Input:
+    //  changedAdjacencies: indices into adjSpaces to rematch, e.g., all adjacencies of the edited tangent spaces.
+    template<typename Scalar>
+    IGL_INLINE void principal_matching(directional::CartesianFieldT<Scalar>& field,
+                                       const Eigen::VectorXi& changedAdjacencies)
+    {
+        using namespace Eigen;
+
+        Matrix<Scalar, Dynamic, 1> prevEffort(changedAdjacencies.size());
+        for (int k=0;k<changedAdjacencies.size();k++)
+            prevEffort(k)=field.effort(changedAdjacencies(k));
+
+        for (int k=0;k<changedAdjacencies.size();k++){
+            const int i=changedAdjacencies(k);
+            switch (field.N){
+                case 1: principal_matching_kernel<Scalar, 1>(field, i, i+1); break;
+                case 2: principal_matching_kernel<Scalar, 2>(field, i, i+1); break;
+                case 4: principal_matching_kernel<Scalar, 4>(field, i, i+1); break;
+                case 6: principal_matching_kernel<Scalar, 6>(field, i, i+1); break;
+                default: principal_matching_kernel<Scalar, Dynamic>(field, i, i+1);
+            }
+        }
+
+        effort_to_indices(field, changedAdjacencies, prevEffort);
+    }
 }
 
 
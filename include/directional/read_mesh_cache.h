@@ -0,0 +1,64 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2022 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_READ_MESH_CACHE_H
+#define DIRECTIONAL_READ_MESH_CACHE_H
+#include <string>
+#include <directional/mesh_cache.h>
+#include <directional/TriMesh.h>
+#include <directional/IntrinsicFaceTangentBundle.h>
+#include <directional/IntrinsicVertexTangentBundle.h>
+
+namespace directional
+{
+    // Reads a mesh and its tangent bundle from a binary cache written by write_mesh_cache(). No topology is recomputed: the result is identical to
+    // calling set_mesh() and init() on the original mesh (the dense one-rings VE/VF are rebuilt from the cache if mesh.denseOneRings is set).
+    // Inputs:
+    //   fileName: The to be loaded file.
+    //   useMmap: read the file through a memory map (POSIX only; otherwise, or if mapping fails, the file is read with a single bulk read).
+    // Outputs:
+    //   mesh: the loaded TriMesh.
+    //   ftb/vtb: the loaded tangent bundle, pointing to mesh.
+    // Return:
+    //   Whether or not the file was read successfully. Fails on a cache of a different version, bundle type, or machine representation.
+    bool IGL_INLINE read_mesh_cache(const std::string &fileName,
+                                    directional::TriMesh& mesh,
+                                    directional::IntrinsicFaceTangentBundle& ftb,
+                                    const bool useMmap=true)
+    {
+        MeshCacheReader reader(fileName, useMmap);
+        if (!reader.read_header(ftb.discTangType()))
+            return false;
+        reader.read_mesh(mesh);
+        reader.read_bundle(ftb);
+        ftb.mesh = &mesh;
+        return reader.good();
+    }
+
+    bool IGL_INLINE read_mesh_cache(const std::string &fileName,
+                                    directional::TriMesh& mesh,
+                                    directional::IntrinsicVertexTangentBundle& vtb,
+                                    const bool useMmap=true)
+    {
+        MeshCacheReader reader(fileName, useMmap);
+        if (!reader.read_header(vtb.discTangType()))
+            return false;
+        reader.read_mesh(mesh);
+        reader.read_bundle(vtb);
+        reader.read_matrix(vtb.oneRingTangentStartAngles);
+        vtb.mesh = &mesh;
+        if (reader.good() && mesh.denseOneRings){
+            vtb.compute_dense_one_rings();
+            vtb.compute_dense_tangent_start_angles();
+        } else {
+            vtb.oneRing.resize(0,0);
+            vtb.tangentStartAngles.resize(0,0);
+        }
+        return reader.good();
+    }
+}
+
+#endif
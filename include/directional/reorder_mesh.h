@@ -0,0 +1,179 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2022 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_REORDER_MESH_H
+#define DIRECTIONAL_REORDER_MESH_H
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <Eigen/Core>
+#include <igl/igl_inline.h>
+
+namespace directional
+{
+    //INPUT keeps the input order. BFS is a reverse Cuthill-McKee order of the vertex graph (small bandwidth, which also reduces the fill-in of sparse factorizations),
+    //and MORTON sorts the vertices along a Z-order space-filling curve of their positions.
+    enum class elementOrderTypeEnum {INPUT, BFS, MORTON};
+
+    // Reorders the vertices and faces of a mesh for memory locality. Faces are sorted by their (sorted) new vertex indices, so that adjacent faces,
+    // and the edges between them (which edge_topology() enumerates by vertex) get close indices. The corners of each face are kept in the same order.
+    // Inputs:
+    //   V: #V x 3 vertex coordinates.
+    //   F: #F x 3 faces.
+    //   orderType: the order to use.
+    // Outputs:
+    //   VOut, FOut: the reordered mesh.
+    //   vertexOrder: #V, the input index of every new vertex (i.e., VOut.row(i)=V.row(vertexOrder(i))).
+    //   faceOrder: #F, the input index of every new face.
+    template<typename Scalar>
+    void IGL_INLINE reorder_mesh(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& V,
+                                 const Eigen::MatrixXi& F,
+                                 const elementOrderTypeEnum orderType,
+                                 Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& VOut,
+                                 Eigen::MatrixXi& FOut,
+                                 Eigen::VectorXi& vertexOrder,
+                                 Eigen::VectorXi& faceOrder)
+    {
+        vertexOrder = Eigen::VectorXi::LinSpaced(V.rows(), 0, V.rows()-1);
+        faceOrder = Eigen::VectorXi::LinSpaced(F.rows(), 0, F.rows()-1);
+        if (orderType==elementOrderTypeEnum::INPUT){
+            VOut = V;
+            FOut = F;
+            return;
+        }
+
+        if (orderType==elementOrderTypeEnum::BFS){
+            //vertex graph in compressed form
+            std::vector<int> adjOffsets(V.rows()+1,0), adjVertices(6*F.rows());
+            for (int i=0;i<F.rows();i++)
+                for (int j=0;j<3;j++){
+                    adjOffsets[F(i,j)+1]++;
+                    adjOffsets[F(i,(j+1)%3)+1]++;
+                }
+            for (int i=0;i<V.rows();i++)
+                adjOffsets[i+1]+=adjOffsets[i];
+            std::vector<int> counter(adjOffsets.begin(), adjOffsets.end()-1);
+            for (int i=0;i<F.rows();i++)
+                for (int j=0;j<3;j++){
+                    adjVertices[counter[F(i,j)]++]=F(i,(j+1)%3);
+                    adjVertices[counter[F(i,(j+1)%3)]++]=F(i,j);
+                }
+            //removing duplicates (every inner edge appears twice)
+            std::vector<int> degree(V.rows());
+            int numAdj=0;
+            for (int i=0;i<V.rows();i++){
+                std::sort(adjVertices.begin()+adjOffsets[i], adjVertices.begin()+adjOffsets[i+1]);
+                int ringEnd = std::unique(adjVertices.begin()+adjOffsets[i], adjVertices.begin()+adjOffsets[i+1])-adjVertices.begin();
+                int ringStart = numAdj;
+                for (int j=adjOffsets[i];j<ringEnd;j++)
+                    adjVertices[numAdj++]=adjVertices[j];
+                adjOffsets[i]=ringStart;
+                degree[i]=numAdj-ringStart;
+            }
+            adjOffsets[V.rows()]=numAdj;
+
+            std::vector<int> byDegree(V.rows());
+            std::iota(byDegree.begin(), byDegree.end(), 0);
+            std::stable_sort(byDegree.begin(), byDegree.end(), [&](const int a, const int b){return degree[a]<degree[b];});
+
+            //level-structured BFS from root, visiting the neighbors of each vertex by increasing degree; returns the start of the last level
+            std::vector<int> level(V.rows(), -1), queue;
+            std::vector<int> neighbors;
+            auto bfs = [&](const int root, const int mark){
+                size_t queueStart = queue.size();
+                queue.push_back(root);
+                level[root] = mark;
+                size_t lastLevelStart = queueStart, currLevelEnd = queue.size();
+                for (size_t q=queueStart;q<queue.size();q++){
+                    if (q==currLevelEnd){
+                        lastLevelStart = q;
+                        currLevelEnd = queue.size();
+                    }
+                    const int v = queue[q];
+                    neighbors.assign(adjVertices.begin()+adjOffsets[v], adjVertices.begin()+adjOffsets[v+1]);
+                    std::stable_sort(neighbors.begin(), neighbors.end(), [&](const int a, const int b){return degree[a]<degree[b];});
+                    for (int j=0;j<neighbors.size();j++)
+                        if (level[neighbors[j]]!=mark){
+                            level[neighbors[j]] = mark;
+                            queue.push_back(neighbors[j]);
+                        }
+                }
+                return lastLevelStart;
+            };
+
+            std::vector<int> cmOrder;
+            std::vector<char> visited(V.rows(), 0);
+            cmOrder.reserve(V.rows());
+            for (int i=0;i<byDegree.size();i++){
+                if (visited[byDegree[i]])
+                    continue;
+                //pseudo-peripheral root: a minimum-degree vertex of the last level of a BFS from the minimum-degree vertex of the component
+                queue.clear();
+                size_t lastLevelStart = bfs(byDegree[i], -2);
+                int root = queue[lastLevelStart];
+                for (size_t q=lastLevelStart;q<queue.size();q++)
+                    if (degree[queue[q]]<degree[root])
+                        root = queue[q];
+                for (size_t q=0;q<queue.size();q++)
+                    level[queue[q]] = -1;
+                queue.clear();
+                bfs(root, -3);
+                for (size_t q=0;q<queue.size();q++){
+                    visited[queue[q]] = 1;
+                    cmOrder.push_back(queue[q]);
+                }
+            }
+            for (int i=0;i<V.rows();i++)
+                vertexOrder(i) = cmOrder[V.rows()-1-i];
+        }
+
+        if (orderType==elementOrderTypeEnum::MORTON){
+            Eigen::RowVector3d minBox = V.colwise().minCoeff().template cast<double>();
+            Eigen::RowVector3d boxSize = (V.colwise().maxCoeff().template cast<double>()-minBox).cwiseMax(1e-300);
+            std::vector<std::uint64_t> codes(V.rows());
+            for (int i=0;i<V.rows();i++){
+                std::uint64_t code=0;
+                for (int j=0;j<3;j++){
+                    std::uint64_t coord = (std::uint64_t)(std::min(std::max(((double)V(i,j)-minBox(j))/boxSize(j), 0.0), 1.0)*((1<<21)-1));
+                    for (int b=0;b<21;b++)
+                        code |= ((coord>>b)&1)<<(3*b+j);
+                }
+                codes[i]=code;
+            }
+            std::stable_sort(vertexOrder.data(), vertexOrder.data()+vertexOrder.size(), [&](const int a, const int b){return codes[a]<codes[b];});
+        }
+
+        Eigen::VectorXi newVertexIndex(V.rows());
+        VOut.resize(V.rows(), V.cols());
+        for (int i=0;i<V.rows();i++){
+            newVertexIndex(vertexOrder(i))=i;
+            VOut.row(i)=V.row(vertexOrder(i));
+        }
+
+        Eigen::MatrixXi newF(F.rows(), F.cols()), sortedF(F.rows(), F.cols());
+        for (int i=0;i<F.rows();i++){
+            for (int j=0;j<F.cols();j++)
+                newF(i,j)=newVertexIndex(F(i,j));
+            Eigen::RowVectorXi corners = newF.row(i);
+            std::sort(corners.data(), corners.data()+corners.size());
+            sortedF.row(i)=corners;
+        }
+
+        std::stable_sort(faceOrder.data(), faceOrder.data()+faceOrder.size(), [&](const int a, const int b){
+            for (int j=0;j<sortedF.cols();j++)
+                if (sortedF(a,j)!=sortedF(b,j))
+                    return sortedF(a,j)<sortedF(b,j);
+            return false;
+        });
+
+        FOut.resize(F.rows(), F.cols());
+        for (int i=0;i<F.rows();i++)
+            FOut.row(i)=newF.row(faceOrder(i));
+    }
+}
+
+#endif
@@ -7,7 +7,10 @@
 #ifndef DIRECTIONAL_ROTATION_TO_RAW_H
 #define DIRECTIONAL_ROTATION_TO_RAW_H
 
+#include <vector>
 #include <directional/CartesianField.h>
+#include <directional/conjugate_gradient.h>
+#include <directional/connection_laplacian.h>
 
 namespace directional
 {
@@ -17,13 +20,23 @@ namespace directional
     //  rotationAngles: #E angles that encode deviation from parallel transport EF(i,0)->EF(i,1)
     //  N:              The degree of the field.
     //  globalRotation: The angle between the vector on the first face and its basis in radians.
+    //  iterativeSolver: whether to solve for the power field by matrix-free Jacobi-preconditioned conjugate gradient instead of a sparse factorization (for very large meshes).
+    //  iterativeTolerance: the relative residual at which the iterative solver stops.
+    //  treePropagation: whether to first propagate the power field from the first tangent space along a spanning tree, which is exact (and linear time) when the
+    //                   rotation angles are consistent (zero holonomy around all cycles, as after index_prescription()). The least-squares solve above is only
+    //                   used when the result does not satisfy all adjacencies up to consistencyTolerance.
+    //  consistencyTolerance: the largest deviation |transport*z(adjSpaces(i,0))-z(adjSpaces(i,1))| of the (unit) propagated power field that is accepted.
     // Outputs:
     //  field:          The raw Cartesian field.
     IGL_INLINE void rotation_to_raw(const TangentBundle& tb,
                                     const Eigen::VectorXd& rotationAngles,
                                     const int N,
                                     const double globalRotation,
-                                    directional::CartesianField& field)
+                                    directional::CartesianField& field,
+                                    const bool iterativeSolver = false,
+                                    const double iterativeTolerance = 1e-10,
+                                    const bool treePropagation = true,
+                                    const double consistencyTolerance = 1e-8)
     {
         typedef std::complex<double> Complex;
         using namespace Eigen;
@@ -31,32 +44,95 @@ namespace directional
 
         Complex globalRot = exp(Complex(0, globalRotation));
         field.init(tb, fieldTypeEnum::RAW_FIELD, N);
-        SparseMatrix<Complex> aP1Full(tb.adjSpaces.rows(), field.intField.rows());
-        SparseMatrix<Complex> aP1(tb.adjSpaces.rows(), field.intField.rows() - 1);
-        vector<Triplet<Complex> > aP1Triplets, aP1FullTriplets;
-        for (int i = 0; i<tb.adjSpaces.rows(); i++) {
-            if (tb.adjSpaces(i, 0) == -1 || tb.adjSpaces(i, 1) == -1)
-                continue;
+        VectorXcd complexPowerField(field.intField.rows());
+        complexPowerField(0) = globalRot;
+        VectorXcd transports(tb.adjSpaces.rows());
+        for (int i = 0; i<tb.adjSpaces.rows(); i++)
+            transports(i) = pow(tb.connection(i),(double)N)*exp(Complex(0, (double)N*rotationAngles(i)));
+
+        bool propagated = false;
+        if (treePropagation){
+            //breadth-first through the one-rings, on a flat queue that every tangent space enters once
+            vector<int> spaceQueue(field.intField.rows());
+            vector<char> reached(field.intField.rows(), 0);
+            spaceQueue[0] = 0;
+            reached[0] = 1;
+            int queueEnd = 1;
+            for (int queueBegin = 0; queueBegin < queueEnd; queueBegin++){
+                const int currSpace = spaceQueue[queueBegin];
+                for (int j = tb.oneRingOffsets(currSpace); j < tb.oneRingOffsets(currSpace+1); j++){
+                    const int adjacency = tb.oneRingAdjacencies(j);
+                    if (tb.adjSpaces(adjacency, 0) == -1 || tb.adjSpaces(adjacency, 1) == -1)
+                        continue;
+                    const bool isFirst = (tb.adjSpaces(adjacency, 0) == currSpace);
+                    const int nextSpace = tb.adjSpaces(adjacency, isFirst ? 1 : 0);
+                    if (reached[nextSpace])
+                        continue;
+                    complexPowerField(nextSpace) = (isFirst ? transports(adjacency)*complexPowerField(currSpace) : complexPowerField(currSpace)/transports(adjacency));
+                    reached[nextSpace] = 1;
+                    spaceQueue[queueEnd++] = nextSpace;
+                }
+            }
 
-            aP1FullTriplets.push_back(Triplet<Complex>(i, tb.adjSpaces(i, 0), pow(tb.connection(i),(double)N)*exp(Complex(0, (double)N*rotationAngles(i)))));
-            aP1FullTriplets.push_back(Triplet<Complex>(i, tb.adjSpaces(i, 1), -1.0));
-            if (tb.adjSpaces(i, 0) != 0)
-                aP1Triplets.push_back(Triplet<Complex>(i, tb.adjSpaces(i, 0)-1, pow(tb.connection(i),(double)N)*exp(Complex(0, (double)N*rotationAngles(i)))));
-            if (tb.adjSpaces(i, 1) != 0)
-                aP1Triplets.push_back(Triplet<Complex>(i, tb.adjSpaces(i, 1)-1, -1.0));
+            //the non-tree adjacencies hold exactly when the angles are consistent
+            propagated = (queueEnd == field.intField.rows());
+            for (int i = 0; (i<tb.adjSpaces.rows()) && propagated; i++)
+                if (tb.adjSpaces(i, 0) != -1 && tb.adjSpaces(i, 1) != -1)
+                    propagated = (abs(transports(i)*complexPowerField(tb.adjSpaces(i, 0)) - complexPowerField(tb.adjSpaces(i, 1))) <= consistencyTolerance);
         }
-        aP1Full.setFromTriplets(aP1FullTriplets.begin(), aP1FullTriplets.end());
-        aP1.setFromTriplets(aP1Triplets.begin(), aP1Triplets.end());
-        VectorXcd torhs = VectorXcd::Zero(field.intField.rows()); torhs(0) = globalRot;  //global rotation
-        VectorXcd rhs = -aP1Full*torhs;
 
-        Eigen::SimplicialLDLT<Eigen::SparseMatrix<Complex> > solver;
-        solver.compute(aP1.adjoint()*aP1);
-        assert(solver.info() == Success);
-        VectorXcd complexPowerField(field.intField.rows());
-        complexPowerField(0) = globalRot;
-        complexPowerField.tail(field.intField.rows() - 1) = solver.solve(aP1.adjoint()*rhs);
-        assert(solver.info() == Success);
+        if ((!propagated) && iterativeSolver){
+            //the same system, as the connection Laplacian of the rotated transports with the first tangent space fixed, applied without forming it
+            VectorXd weights = VectorXd::Ones(tb.adjSpaces.rows());
+            VectorXd diagonal = connection_laplacian_diagonal(tb, transports, weights, field.intField.rows()).tail(field.intField.rows() - 1);
+            for (int i=0;i<diagonal.size();i++)
+                if (diagonal(i)<=0.0)
+                    diagonal(i)=1.0;  //isolated tangent space
+
+            VectorXcd fullVector = VectorXcd::Zero(field.intField.rows()), fullResult(field.intField.rows());
+            auto applyLhs = [&](const VectorXcd& x, VectorXcd& y){
+                fullVector(0) = 0.0;
+                fullVector.tail(x.size()) = x;
+                fullResult.setZero();
+                connection_laplacian_apply(tb, transports, weights, fullVector, fullResult);
+                y = fullResult.tail(x.size());
+            };
+            auto applyPrecond = [&](const VectorXcd& r, VectorXcd& z){ z = r.cwiseQuotient(diagonal); };
+
+            fullVector.setZero(); fullVector(0) = globalRot;
+            fullResult.setZero();
+            connection_laplacian_apply(tb, transports, weights, fullVector, fullResult);
+            VectorXcd rhs = -fullResult.tail(field.intField.rows() - 1);
+            VectorXcd freePowerField;
+            bool converged = conjugate_gradient(applyLhs, applyPrecond, rhs, freePowerField, iterativeTolerance, 100*field.intField.rows());
+            assert(converged && "rotation_to_raw(): conjugate gradient did not converge");
+            complexPowerField.tail(field.intField.rows() - 1) = freePowerField;
+        } else if (!propagated) {
+            SparseMatrix<Complex> aP1Full(tb.adjSpaces.rows(), field.intField.rows());
+            SparseMatrix<Complex> aP1(tb.adjSpaces.rows(), field.intField.rows() - 1);
+            vector<Triplet<Complex> > aP1Triplets, aP1FullTriplets;
+            for (int i = 0; i<tb.adjSpaces.rows(); i++) {
+                if (tb.adjSpaces(i, 0) == -1 || tb.adjSpaces(i, 1) == -1)
+                    continue;
+
+                aP1FullTriplets.push_back(Triplet<Complex>(i, tb.adjSpaces(i, 0), transports(i)));
+                aP1FullTriplets.push_back(Triplet<Complex>(i, tb.adjSpaces(i, 1), -1.0));
+                if (tb.adjSpaces(i, 0) != 0)
+                    aP1Triplets.push_back(Triplet<Complex>(i, tb.adjSpaces(i, 0)-1, transports(i)));
+                if (tb.adjSpaces(i, 1) != 0)
+                    aP1Triplets.push_back(Triplet<Complex>(i, tb.adjSpaces(i, 1)-1, -1.0));
+            }
+            aP1Full.setFromTriplets(aP1FullTriplets.begin(), aP1FullTriplets.end());
+            aP1.setFromTriplets(aP1Triplets.begin(), aP1Triplets.end());
+            VectorXcd torhs = VectorXcd::Zero(field.intField.rows()); torhs(0) = globalRot;  //global rotation
+            VectorXcd rhs = -aP1Full*torhs;
+
+            Eigen::SimplicialLDLT<Eigen::SparseMatrix<Complex> > solver;
+            solver.compute(aP1.adjoint()*aP1);
+            assert(solver.info() == Success);
+            complexPowerField.tail(field.intField.rows() - 1) = solver.solve(aP1.adjoint()*rhs);
+            assert(solver.info() == Success);
+        }
 
         VectorXcd complexField = pow(complexPowerField.array(), 1.0 / (double)N);
 
@@ -35,13 +35,18 @@ namespace directional
             Valences(EV(i,1))++;
         }
 
-        MatrixXi VE(numV, Valences.maxCoeff());
-        Valences.setZero();
+        //compressed vertex-edge adjacency
+        VectorXi VEOffsets(numV+1);
+        VEOffsets(0)=0;
+        for (int i=0;i<numV;i++)
+            VEOffsets(i+1)=VEOffsets(i)+Valences(i);
+        VectorXi VE(VEOffsets(numV));
+        VectorXi VECounter=VEOffsets.head(numV);
         for (int i=0;i<EV.rows();i++){
             if (EV(i, 0) == -1 || EV(i, 1) == -1)
                 continue;
-            VE(EV(i,0), Valences(EV(i,0))++)=i;
-            VE(EV(i,1), Valences(EV(i,1))++)=i;
+            VE(VECounter(EV(i,0))++)=i;
+            VE(VECounter(EV(i,1))++)=i;
         }
 
         Eigen::VectorXi usedVertices=VectorXi::Zero(numV);
@@ -73,8 +78,8 @@ namespace directional
             usedVertices(currEdgeVertex.second)=1;
 
             //inserting the new unused vertices
-            for (int i=0;i<Valences(currEdgeVertex.second);i++){
-                int nextEdge=VE(currEdgeVertex.second, i);
+            for (int i=VEOffsets(currEdgeVertex.second);i<VEOffsets(currEdgeVertex.second+1);i++){
+                int nextEdge=VE(i);
                 int nextVertex=(EV(nextEdge, 0)==currEdgeVertex.second ? EV(nextEdge, 1) : EV(nextEdge, 0));
                 if (!usedVertices(nextVertex))
                     edgeVertices.push(std::pair<int, int>(nextEdge, nextVertex));
@@ -0,0 +1,54 @@
+// This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2022 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_WRITE_MESH_CACHE_H
+#define DIRECTIONAL_WRITE_MESH_CACHE_H
+#include <string>
+#include <directional/mesh_cache.h>
+#include <directional/TriMesh.h>
+#include <directional/IntrinsicFaceTangentBundle.h>
+#include <directional/IntrinsicVertexTangentBundle.h>
+
+namespace directional
+{
+    // Writes a fully-built mesh and its tangent bundle to a binary cache file, to be loaded with read_mesh_cache() without recomputing any topology.
+    // Inputs:
+    //   fileName: The file name to which the cache should be saved.
+    //   mesh: a TriMesh after set_mesh().
+    //   ftb/vtb: the tangent bundle, after init() on mesh.
+    // Return:
+    //   Whether or not the file was written successfully
+    bool IGL_INLINE write_mesh_cache(const std::string &fileName,
+                                     const directional::TriMesh& mesh,
+                                     const directional::IntrinsicFaceTangentBundle& ftb)
+    {
+        MeshCacheWriter writer(fileName);
+        if (!writer.f.is_open())
+            return false;
+        writer.write_header(ftb.discTangType());
+        writer.write_mesh(mesh);
+        writer.write_bundle(ftb);
+        writer.f.close();
+        return !writer.f.fail();
+    }
+
+    bool IGL_INLINE write_mesh_cache(const std::string &fileName,
+                                     const directional::TriMesh& mesh,
+                                     const directional::IntrinsicVertexTangentBundle& vtb)
+    {
+        MeshCacheWriter writer(fileName);
+        if (!writer.f.is_open())
+            return false;
+        writer.write_header(vtb.discTangType());
+        writer.write_mesh(mesh);
+        writer.write_bundle(vtb);
+        writer.write_matrix(vtb.oneRingTangentStartAngles);
+        writer.f.close();
+        return !writer.f.fail();
+    }
+}
+
+#endif
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <Eigen/Core>
+#include <Eigen/Sparse>
+#include <igl/PI.h>
+#include <directional/TriMesh.h>
+#include <directional/readOFF.h>
+#include <directional/readOBJ.h>
+#include <directional/dual_cycles.h>
+#include "reference_dual_cycles.h"
+
+/***
+ Checks dual_cycles() against the set-based reference implementation it replaced, on closed, bounded and higher-genus meshes.
+ The cycle matrix, curvatures, vertex-to-cycle map and inner edges are expected to be identical, except for one fix: the reference
+ added generator k into boundary cycle k (and left the last rows empty) on meshes that have both boundaries and generators.
+ On such meshes, the reference is compared against the new cycles merged in the same way.
+ ***/
+
+double elapsed(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+// n x m grid, wrapped in u and/or v into a cylinder or a torus, with the faces in holes removed
+void make_grid(const int n, const int m, const bool wrapU, const bool wrapV, const std::vector<int>& holes, Eigen::MatrixXd& V, Eigen::MatrixXi& F)
+{
+  std::mt19937 generator(n*m);
+  std::uniform_real_distribution<double> noise(-0.05,0.05);
+  const int nu=(wrapU ? n : n+1), nv=(wrapV ? m : m+1);
+  V.resize(nu*nv,3);
+  for (int i=0;i<nu;i++)
+    for (int j=0;j<nv;j++){
+      const double a=2.0*igl::PI*i/n, b=2.0*igl::PI*j/m;
+      if (wrapU && wrapV)
+        V.row(i*nv+j)<<(3.0+cos(b))*cos(a), (3.0+cos(b))*sin(a), sin(b);
+      else if (wrapU)
+        V.row(i*nv+j)<<cos(a), sin(a), 0.3*j;
+      else
+        V.row(i*nv+j)<<0.3*i, 0.3*j, 0.0;
+      V.row(i*nv+j).array()+=Eigen::RowVector3d(noise(generator), noise(generator), noise(generator)).array();
+    }
+
+  std::vector<Eigen::RowVector3i> faces;
+  for (int i=0;i<n;i++)
+    for (int j=0;j<m;j++){
+      if (std::find(holes.begin(), holes.end(), i*m+j)!=holes.end())
+        continue;
+      const int v00=i*nv+j, v10=((i+1)%nu)*nv+j, v11=((i+1)%nu)*nv+(j+1)%nv, v01=i*nv+(j+1)%nv;
+      faces.push_back(Eigen::RowVector3i(v00,v10,v11));
+      faces.push_back(Eigen::RowVector3i(v00,v11,v01));
+    }
+  F.resize(faces.size(),3);
+  for (int i=0;i<faces.size();i++)
+    F.row(i)=faces[i];
+}
+
+bool check_mesh(const std::string& name, const directional::TriMesh& mesh)
+{
+  using namespace Eigen;
+  const double tolerance=1e-10;
+
+  SparseMatrix<double> refCycles, cycles;
+  VectorXd refCurvatures, curvatures;
+  VectorXi refLocal2Cycle, local2Cycle, refInnerAdjacencies, innerAdjacencies;
+
+  auto start=std::chrono::steady_clock::now();
+  directional_reference::dual_cycles(mesh.V, mesh.F, mesh.EV, mesh.EF, refCycles, refCurvatures, refLocal2Cycle, refInnerAdjacencies);
+  const double refTime=elapsed(start);
+  start=std::chrono::steady_clock::now();
+  directional::dual_cycles(mesh.V, mesh.F, mesh.EV, mesh.EF, cycles, curvatures, local2Cycle, innerAdjacencies);
+  const double time=elapsed(start);
+
+  const int numBoundaries=mesh.boundaryLoops.size();
+  int numInner=mesh.V.rows();
+  for (int i=0;i<numBoundaries;i++)
+    numInner-=mesh.boundaryLoops[i].size();
+  const int numGenerators=cycles.rows()-numInner-numBoundaries;
+  std::cout<<name<<": "<<mesh.F.rows()<<" faces, "<<numBoundaries<<" boundaries, "<<numGenerators<<" generators, reference "<<refTime<<"s, new "<<time<<"s"<<std::endl;
+
+  bool passed=true;
+  auto report=[&](const bool ok, const std::string& what){
+    if (!ok)
+      std::cout<<"  FAILED: "<<what<<std::endl;
+    passed=passed && ok;
+  };
+
+  report((refCycles.rows()==cycles.rows())&&(refCycles.cols()==cycles.cols()), "cycle matrix size");
+  report(refLocal2Cycle==local2Cycle, "local2Cycle");
+  report(refInnerAdjacencies==innerAdjacencies, "innerAdjacencies");
+  if (!passed)
+    return false;
+
+  //the new cycles merged as the reference did: generator k added into boundary cycle k (the identity when there are no boundaries or no generators)
+  std::vector<Triplet<double>> mergeTriplets;
+  for (int i=0;i<numInner+numBoundaries;i++)
+    mergeTriplets.push_back(Triplet<double>(i,i,1.0));
+  for (int i=0;i<numGenerators;i++)
+    mergeTriplets.push_back(Triplet<double>(numInner+i,numInner+numBoundaries+i,1.0));
+  SparseMatrix<double> mergeMat(cycles.rows(), cycles.rows());
+  mergeMat.setFromTriplets(mergeTriplets.begin(), mergeTriplets.end());
+  SparseMatrix<double> mergedCycles=mergeMat*cycles;
+
+  report((refCycles-mergedCycles).norm()==0.0, "cycle matrix");
+  report((refCurvatures.head(numInner)-curvatures.head(numInner)).lpNorm<Infinity>()<tolerance, "inner-vertex cycle curvatures");
+  VectorXd mergedCurvatures;
+  directional::dual_cycle_curvatures(mesh.V, mesh.F, mesh.EV, mesh.EF, mergedCycles, local2Cycle, innerAdjacencies, mergedCurvatures);
+  report((refCurvatures-mergedCurvatures).lpNorm<Infinity>()<tolerance, "cycle curvatures");
+  if ((numBoundaries==0)||(numGenerators==0))
+    report((refCurvatures-curvatures).lpNorm<Infinity>()<tolerance, "cycle curvatures (no merged cycles)");
+
+  //index sums: for arbitrary rotation angles, the holonomy of each (merged) cycle and the total over all cycles are the same
+  VectorXd rotationAngles=VectorXd::Random(cycles.cols());
+  VectorXd refHolonomies=refCycles*rotationAngles;
+  VectorXd holonomies=cycles*rotationAngles;
+  report((refHolonomies-mergeMat*holonomies).lpNorm<Infinity>()<tolerance, "cycle holonomies");
+  report(std::abs(refHolonomies.sum()-holonomies.sum())<tolerance*cycles.cols(), "total holonomy (index sum)");
+
+  //the inner-vertex and boundary cycles add up to the Euler characteristic (what index prescription relies on)
+  const double curvatureSum=curvatures.head(numInner+numBoundaries).sum();
+  report(std::abs(curvatureSum-2.0*igl::PI*mesh.eulerChar)<tolerance*cycles.rows(), "Gauss-Bonnet over inner and boundary cycles");
+
+  return passed;
+}
+
+int main()
+{
+  int numFailed=0;
+  directional::TriMesh mesh;
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+
+  make_grid(12, 10, false, false, {}, V, F);
+  mesh.set_mesh(V,F);
+  numFailed+=!check_mesh("disk", mesh);
+  make_grid(12, 10, true, false, {}, V, F);
+  mesh.set_mesh(V,F);
+  numFailed+=!check_mesh("cylinder", mesh);
+  make_grid(12, 10, true, true, {}, V, F);
+  mesh.set_mesh(V,F);
+  numFailed+=!check_mesh("torus", mesh);
+  make_grid(12, 10, true, true, {25, 84}, V, F);
+  mesh.set_mesh(V,F);
+  numFailed+=!check_mesh("torus with two holes", mesh);
+
+  directional::readOFF(TUTORIAL_SHARED_PATH "/eight.off", mesh);
+  numFailed+=!check_mesh("eight.off", mesh);
+  directional::readOFF(TUTORIAL_SHARED_PATH "/bunny.off", mesh);
+  numFailed+=!check_mesh("bunny.off", mesh);
+  directional::readOBJ(TUTORIAL_SHARED_PATH "/chipped-torus.obj", mesh);
+  numFailed+=!check_mesh("chipped-torus.obj", mesh);
+  directional::readOBJ(TUTORIAL_SHARED_PATH "/half-torus.obj", mesh);
+  numFailed+=!check_mesh("half-torus.obj", mesh);
+  directional::readOFF(TUTORIAL_SHARED_PATH "/fertility.off", mesh);
+  numFailed+=!check_mesh("fertility.off", mesh);
+
+  std::cout<<(numFailed==0 ? "All dual cycle checks passed." : "Some dual cycle checks failed.")<<std::endl;
+  return (numFailed==0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
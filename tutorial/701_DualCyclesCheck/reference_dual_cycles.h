@@ -0,0 +1,351 @@
+//This file is part of Directional, a library for directional field processing.
+// Copyright (C) 2016 Amir Vaxman <avaxman@gmail.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef DIRECTIONAL_REFERENCE_DUAL_CYCLES_H
+#define DIRECTIONAL_REFERENCE_DUAL_CYCLES_H
+#include <Eigen/Core>
+#include <igl/boundary_loop.h>
+#include <igl/local_basis.h>
+#include <igl/gaussian_curvature.h>
+#include <igl/colon.h>
+#include <igl/setdiff.h>
+#include <igl/slice.h>
+#include <igl/unique.h>
+#include <igl/edge_topology.h>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <directional/tree.h>
+
+//The set-based dual_cycles() (and dual_cycle_curvatures()) as they were before dual_cycles() was rebuilt on flat arrays, kept verbatim
+//as the reference for the check in main.cpp.
+namespace directional_reference
+{
+  using directional::tree;
+
+  // Computes the curvature of the dual cycles produced by dual_cycles(). This only depends on the geometry, and so can be reevaluated for new vertex positions without recomputing the cycles.
+  // Input:
+  //  V, F, EV, EF:     the mesh (as in dual_cycles()).
+  //  basisCycles:      #c by #iE basis cycles from dual_cycles()
+  //  vertex2cycle:     #v by 1 map between vertices and cycles from dual_cycles()
+  //  innerEdges:       #iE by 1 inner edges from dual_cycles()
+  // Output:
+  //  cycleCurvature:   #c by 1 curvatures of each cycle
+  template<typename Scalar>
+  IGL_INLINE void dual_cycle_curvatures(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& V,
+                                        const Eigen::MatrixXi& F,
+                                        const Eigen::MatrixXi& EV,
+                                        const Eigen::MatrixXi& EF,
+                                        const Eigen::SparseMatrix<double>& basisCycles,
+                                        const Eigen::VectorXi& vertex2cycle,
+                                        const Eigen::VectorXi& innerEdges,
+                                        Eigen::Matrix<Scalar, Eigen::Dynamic, 1>& cycleCurvature)
+  {
+    using namespace Eigen;
+    using namespace std;
+
+    //Correct computation of cycle curvature by adding angles
+    //getting corner angle sum
+    Matrix<Scalar, Dynamic, 1> allAngles(3*F.rows());
+    for (int i=0;i<F.rows();i++){
+      for (int j=0;j<3;j++){
+        Matrix<Scalar, 1, 3> edgeVec12=V.row(F(i,(j+1)%3))-V.row(F(i,j));
+        Matrix<Scalar, 1, 3> edgeVec13=V.row(F(i,(j+2)%3))-V.row(F(i,j));
+        allAngles(3*i+j)=acos(edgeVec12.normalized().dot(edgeVec13.normalized()));
+      }
+    }
+
+    //for each cycle, summing up all its internal angles negatively  + either 2*pi*|cycle| for internal cycles or pi*|cycle| for boundary cycles.
+    //Inner-vertex cycles are exactly those that a single vertex maps to (boundary cycles have all their vertices mapped to them, and generators none).
+    cycleCurvature=Matrix<Scalar, Dynamic, 1>::Zero(basisCycles.rows());
+    VectorXi cycleVertexCount=VectorXi::Zero(basisCycles.rows());
+    for (int i=0;i<vertex2cycle.size();i++)
+      if ((vertex2cycle(i)>=0)&&(vertex2cycle(i)<basisCycles.rows()))
+        cycleVertexCount(vertex2cycle(i))++;
+    VectorXi isBigCycle=(cycleVertexCount.array()!=1).cast<int>();
+
+    //getting the 4 corners of each edge to allocated later to cycles according to the sign of the edge.
+    vector<set<int>> cornerSets(basisCycles.rows());
+    vector<set<int>> vertexSets(basisCycles.rows());
+    MatrixXi edgeCorners(innerEdges.size(),4);
+    for (int i=0;i<innerEdges.rows();i++){
+      int inFace1=0;
+      while (F(EF(innerEdges(i),0),inFace1)!=EV(innerEdges(i),0))
+        inFace1=(inFace1+1)%3;
+      int inFace2=0;
+      while (F(EF(innerEdges(i),1),inFace2)!=EV(innerEdges(i),1))
+        inFace2=(inFace2+1)%3;
+
+      edgeCorners(i,0)=EF(innerEdges(i),0)*3+inFace1;
+      edgeCorners(i,1)=EF(innerEdges(i),1)*3+(inFace2+1)%3;
+      edgeCorners(i,2)=EF(innerEdges(i),0)*3+(inFace1+1)%3;
+      edgeCorners(i,3)=EF(innerEdges(i),1)*3+inFace2;
+    }
+
+    for (int k=0; k<basisCycles.outerSize(); ++k)
+      for (SparseMatrix<double>::InnerIterator it(basisCycles,k); it; ++it){
+        cornerSets[it.row()].insert(edgeCorners(it.col(),it.value()<0 ? 0 : 2));
+        cornerSets[it.row()].insert(edgeCorners(it.col(),it.value()<0 ? 1 : 3));
+        vertexSets[it.row()].insert(EV(innerEdges(it.col()), it.value()<0 ? 0 : 1));
+      }
+
+    for (int i=0;i<cornerSets.size();i++){
+      if (isBigCycle(i))
+        cycleCurvature(i)=igl::PI*(double)(vertexSets[i].size());
+      else
+        cycleCurvature(i)=2.0*igl::PI;
+      for (set<int>::iterator si=cornerSets[i].begin();si!=cornerSets[i].end();si++)
+        cycleCurvature(i)-=allAngles(*si);
+    }
+  }
+
+  // Creates the set of independent dual cycles (closed loops of connected faces that cannot be morphed to each other) on a mesh. Primarily used for index prescription.
+  // The basis cycle matrix first contains #V-#b cycles for every inner vertex (by order), then #b boundary cycles, and finally 2*g generator cycles around all handles. Total #c cycles.The cycle matrix sums information on the dual edges between the faces, and is indexed into the inner edges alone (excluding boundary)
+  //input:
+  //  V: #V by 3 vertices.
+  //  F: #F by 3 triangles.
+  //  EV: #E by 2 matrix of edges (vertex indices)
+  //  EF: #E by 2 matrix of oriented adjacent faces
+  //output:
+  //  basisCycles:    #c by #iE basis cycles
+  //  cycleCurvature:   #c by 1 curvatures of each cycle (for inner-vertex cycles, simply the Gaussian curvature.
+  //  vertex2cycle:     #v by 1 map between vertex and corresponding cycle (for comfort of input from the user's side; inner vertices map to their cycles, boundary vertices to the bigger boundary cycle.
+  //  innerEdges:       #iE by 1 the subset of #EV that are inner edges, and with the same ordering as the columns of basisCycles.
+  
+  template<typename Scalar>
+  IGL_INLINE void dual_cycles(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>& V,
+                              const Eigen::MatrixXi& F,
+                              const Eigen::MatrixXi& EV,
+                              const Eigen::MatrixXi& EF,
+                              Eigen::SparseMatrix<double>& basisCycles,
+                              Eigen::Matrix<Scalar, Eigen::Dynamic, 1>& cycleCurvature,
+                              Eigen::VectorXi& vertex2cycle,
+                              Eigen::VectorXi& innerEdges)
+  {
+    using namespace Eigen;
+    using namespace std;
+    int numV = F.maxCoeff() + 1;
+    int eulerChar = numV - EV.rows() + F.rows();
+    vertex2cycle.conservativeResize(V.rows());
+    
+    std::vector<std::vector<int>> boundaryLoops;
+    
+    igl::boundary_loop(F, boundaryLoops);
+    int numBoundaries=boundaryLoops.size();
+    int numGenerators=2-numBoundaries-eulerChar;
+    
+    vector<Triplet<double> > basisCycleTriplets(EV.rows() * 2);
+    
+    //all 1-ring cycles, including boundaries
+    for (int i = 0; i < EV.rows(); i++) {
+      basisCycleTriplets.push_back(Triplet<double>(EV(i, 0), i, -1.0));
+      basisCycleTriplets.push_back(Triplet<double>(EV(i, 1), i, 1.0));
+    }
+    
+    //Creating boundary cycles by building a matrix the sums up boundary loops and zeros out boundary vertex cycles - it will be multiplied from the left to basisCyclesMat
+    VectorXi isBoundary(V.rows()); isBoundary.setZero();
+    for (int i=0;i<boundaryLoops.size();i++)
+      for (int j=0;j<boundaryLoops[i].size();j++)
+        isBoundary(boundaryLoops[i][j])=1;
+    
+    VectorXi pureInnerEdgeMask=VectorXi::Constant(EV.rows(),1);
+    for (int i=0;i<EV.rows();i++)
+      if ((isBoundary(EV(i,0)))||(isBoundary(EV(i,1))))
+        pureInnerEdgeMask(i)=0;
+    
+    int currGeneratorCycle=0;
+    int currBoundaryCycle=0;
+    
+    if ((numGenerators!=0)/*||(numBoundaries!=0)*/){
+      MatrixXi reducedEV(EV);
+      for (int i = 1; i < reducedEV.rows(); i++)
+        if(isBoundary(reducedEV(i,0)) || isBoundary(reducedEV(i, 1)))
+          reducedEV(i,0) = -1;
+      
+      VectorXi primalTreeEdges, primalTreeFathers;
+      VectorXi dualTreeEdges, dualTreeFathers;
+      tree(reducedEV, primalTreeEdges, primalTreeFathers);
+      //creating a set of dual edges that do not cross edges in the primal tree
+      VectorXi fullIndices = VectorXi::LinSpaced(EV.rows(), 0, EV.rows() - 1);
+      VectorXi reducedEFIndices, inFullIndices;
+      MatrixXi reducedEF;
+      igl::setdiff(fullIndices, primalTreeEdges, reducedEFIndices, inFullIndices);
+      VectorXi Two = VectorXi::LinSpaced(2, 0, 1);
+      
+      igl::slice(EF, reducedEFIndices, Two, reducedEF);
+      tree(reducedEF, dualTreeEdges, dualTreeFathers);
+      //converting dualTreeEdges from reducedEF to EF
+      for (int i = 0; i < dualTreeEdges.size(); i++)
+        dualTreeEdges(i) = inFullIndices(dualTreeEdges(i));
+      
+      for (int i = 0; i < dualTreeFathers.size(); i++)
+        if (dualTreeFathers(i) != -1 && dualTreeFathers(i) != -2)
+          dualTreeFathers(i) = inFullIndices(dualTreeFathers(i));
+      
+      //building tree co-tree based homological cycles
+      //finding dual edge which are not in the tree, and following their faces to the end
+      VectorXi isinTree = VectorXi::Zero(EF.rows());
+      for (int i = 0; i < dualTreeEdges.size(); i++) {
+        isinTree(dualTreeEdges(i)) = 1;
+      }
+      for (int i = 0; i < primalTreeEdges.size(); i++) {
+        isinTree(primalTreeEdges(i)) = 1;
+      }
+      
+      for (int i = 0; i < isinTree.size(); i++) {
+        if (isinTree(i))
+          continue;
+        
+        //std::cout<<"New Cycle"<<std::endl;
+        //otherwise, follow both end faces to the root and this is the dual cycle
+        if (EF(i, 0) == -1 || EF(i, 1) == -1)
+          continue;
+        std::vector<Triplet<double> > candidateTriplets;
+        //candidateTriplets.push_back(Triplet<double>(0, i, 1.0));
+        Vector2i currLeaves; currLeaves << EF(i, 0), EF(i, 1);
+        VectorXi visitedOnce = VectorXi::Zero(EF.rows());  //used to remove the tail from the LCA to the root
+        bool isBoundaryCycle=true;
+        for (int i = 0; i < 2; i++) { //on leaves
+          int currTreeEdge = -1;  //indexing within dualTreeEdges
+          int currFace = currLeaves(i);
+          currTreeEdge = dualTreeFathers(currFace);
+          if (currTreeEdge == -2)
+          {
+            break;
+          }
+
+          while (currTreeEdge != -1) {
+            //std::cout<<"currTreeEdge: "<<currTreeEdge<<"\n"<<std::endl;
+            //determining orientation of current edge vs. face
+            double sign = ((EF(currTreeEdge, 0) == currFace) != (i == 0) ? 1.0 : -1.0);
+            visitedOnce(currTreeEdge) = 1 - visitedOnce(currTreeEdge);
+            candidateTriplets.push_back(Triplet<double>(0, currTreeEdge, sign));
+            currFace = (EF(currTreeEdge, 0) == currFace ? EF(currTreeEdge, 1) : EF(currTreeEdge, 0));
+            currTreeEdge = dualTreeFathers(currFace);
+          }
+        }
+
+        //only putting in dual edges that are below the LCA
+        for (int i=0;i<candidateTriplets.size();i++)
+          if ((visitedOnce(candidateTriplets[i].col()))&&(pureInnerEdgeMask(candidateTriplets[i].col())))
+            isBoundaryCycle=false;
+        
+        if (isBoundaryCycle)
+          continue; //ignoring those
+        
+        int currRow = (isBoundaryCycle ? numV+currBoundaryCycle : numV+currGeneratorCycle);
+        (isBoundaryCycle ? currBoundaryCycle++ : currGeneratorCycle++);
+        
+        basisCycleTriplets.push_back(Triplet<double>(currRow, i, 1.0));
+        for (size_t i = 0; i < candidateTriplets.size(); i++)
+          if (visitedOnce(candidateTriplets[i].col())){
+            Triplet<double> trueTriplet(currRow,candidateTriplets[i].col(), candidateTriplets[i].value());
+            basisCycleTriplets.push_back(trueTriplet);
+          }
+      }
+      //assert(currBoundaryCycle==numBoundaries && currGeneratorCycle==numGenerators);
+    }
+    
+    numGenerators =currGeneratorCycle;
+    
+    SparseMatrix<double> sumBoundaryLoops(numV+numBoundaries+numGenerators,numV+numGenerators);
+    vector<Triplet<double>> sumBoundaryLoopsTriplets;
+    vector<int> innerVerticesList, innerEdgesList;
+    VectorXi remainRows, remainColumns;
+    
+    for (int i=0;i<numV;i++){
+      sumBoundaryLoopsTriplets.push_back(Triplet<double>(i, i,1.0-isBoundary[i]));
+      if (!isBoundary(i)){
+        innerVerticesList.push_back(i);
+        vertex2cycle(i)=innerVerticesList.size()-1;
+      }
+    }
+    
+    for (int i=0;i<EV.rows();i++)
+      if (!((isBoundary(EV(i,0)))&&(isBoundary(EV(i,1)))))
+        innerEdgesList.push_back(i);
+    
+    //summing up boundary loops
+    for (int i=0;i<boundaryLoops.size();i++)
+      for (int j=0;j<boundaryLoops[i].size();j++){
+        sumBoundaryLoopsTriplets.push_back(Triplet<double>(numV+i, boundaryLoops[i][j],1.0));
+        vertex2cycle(boundaryLoops[i][j])=innerVerticesList.size()+i;
+      }
+    
+    
+    //just passing generators through;
+    for (int i=numV;i<numV+numGenerators;i++)
+      sumBoundaryLoopsTriplets.push_back(Triplet<double>(i, i,1.0));
+    
+    sumBoundaryLoops.setFromTriplets(sumBoundaryLoopsTriplets.begin(), sumBoundaryLoopsTriplets.end());
+    
+    basisCycles.resize(numV+numGenerators, EV.rows());
+    basisCycles.setFromTriplets(basisCycleTriplets.begin(), basisCycleTriplets.end());
+    basisCycles=sumBoundaryLoops*basisCycles;
+    
+    //removing rows and columns
+    remainRows.resize(innerVerticesList.size()+numBoundaries+numGenerators);
+    remainColumns.resize(innerEdgesList.size());
+    for (int i=0;i<innerVerticesList.size();i++)
+      remainRows(i)=innerVerticesList[i];
+    
+    for (int i=0;i<numBoundaries+numGenerators;i++)
+      remainRows(innerVerticesList.size()+i)=numV+i;
+    
+    for (int i=0;i<innerEdgesList.size();i++)
+      remainColumns(i)=innerEdgesList[i];
+    
+    //creating slicing matrices
+    std::vector<Triplet<double> > rowSliceTriplets, colSliceTriplets;
+    for (int i=0;i<remainRows.size();i++)
+      rowSliceTriplets.push_back(Triplet<double>(i, remainRows(i), 1.0));
+    for (int i=0;i<remainColumns.size();i++)
+      colSliceTriplets.push_back(Triplet<double>(remainColumns(i), i, 1.0));
+    
+    SparseMatrix<double> rowSliceMat(remainRows.rows(), basisCycles.rows());
+    rowSliceMat.setFromTriplets(rowSliceTriplets.begin(), rowSliceTriplets.end());
+    
+    SparseMatrix<double> colSliceMat(basisCycles.cols(), remainColumns.rows());
+    colSliceMat.setFromTriplets(colSliceTriplets.begin(), colSliceTriplets.end());
+    
+    basisCycles=rowSliceMat*basisCycles*colSliceMat;
+    
+    innerEdges.conservativeResize(innerEdgesList.size());
+    for (int i=0;i<innerEdgesList.size();i++)
+      innerEdges(i)=innerEdgesList[i];
+    
+    dual_cycle_curvatures(V, F, EV, EF, basisCycles, vertex2cycle, innerEdges, cycleCurvature);
+
+    /***********************Deprecated***************************/
+    //Explanation: currently computing holonomy as curvature.
+    /*VectorXd edgeParallelAngleChange(basisCycles.cols());  //the difference in the angle representation of edge i from EF(i,0) to EF(i,1)
+    //MatrixXd edgeVectors(columns(columns.size() - 1), 3);
+    
+    for (int i = 0; i < innerEdges.rows(); i++) {
+    
+      int currEdge=innerEdges(i);
+      
+      RowVectorXd edgeVectors = (V.row(EV(currEdge, 1)) - V.row(EV(currEdge, 0))).normalized();
+      double x1 = edgeVectors.dot(B1.row(EF(currEdge, 0)));
+      double y1 = edgeVectors.dot(B2.row(EF(currEdge, 0)));
+      double x2 = edgeVectors.dot(B1.row(EF(currEdge, 1)));
+      double y2 = edgeVectors.dot(B2.row(EF(currEdge, 1)));
+      edgeParallelAngleChange(i) = atan2(y2, x2) - atan2(y1, x1);
+    }
+    
+    
+    cycleCurvature = basisCycles*edgeParallelAngleChange;
+    for (int i = 0; i < cycleCurvature.size(); i++) {
+      while (cycleCurvature(i) >= M_PI) cycleCurvature(i) -= 2.0*M_PI;
+      while (cycleCurvature(i) < -M_PI) cycleCurvature(i) += 2.0*M_PI;
+    }*/
+    
+    /***************End of "DEPRECATED"****************/
+  
+  }
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+#include <directional/TriMesh.h>
+#include <directional/IntrinsicFaceTangentBundle.h>
+#include "benchmark_mesh.h"
+
+/***
+ Times the construction of a mesh and its face-based tangent bundle (connection, cycles, curvatures and masses), serially and with parallelConstruction,
+ and reports the time per million faces.
+ Usage: 702_BundleBenchmark_bin [millions of faces...] (default: 0.25 1)
+ ***/
+
+int main(int argc, char *argv[])
+{
+  std::vector<double> megaFaces;
+  for (int i=1;i<argc;i++)
+    megaFaces.push_back(std::stod(argv[i]));
+  if (megaFaces.empty())
+    megaFaces={0.25, 1.0};
+
+  std::cout<<std::setw(10)<<"faces"<<std::setw(10)<<"mode"<<std::setw(12)<<"set_mesh"<<std::setw(12)<<"init"<<std::setw(12)<<"update"<<std::setw(14)<<"s/Mfaces"<<std::endl;
+  for (int i=0;i<megaFaces.size();i++){
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F;
+    benchmark_mesh((int)(megaFaces[i]*1e6), false, V, F);
+
+    for (int parallel=0;parallel<2;parallel++){
+      directional::TriMesh mesh;
+      directional::IntrinsicFaceTangentBundle ftb;
+      mesh.parallelConstruction=parallel;
+
+      auto start=std::chrono::steady_clock::now();
+      mesh.set_mesh(V,F);
+      const double meshTime=benchmark_seconds(start);
+
+      //init() builds the dual cycles and then computes the geometry, update_geometry() only the latter
+      start=std::chrono::steady_clock::now();
+      ftb.init(mesh);
+      const double initTime=benchmark_seconds(start);
+
+      start=std::chrono::steady_clock::now();
+      ftb.update_geometry();
+      const double updateTime=benchmark_seconds(start);
+
+      std::cout<<std::setw(10)<<F.rows()<<std::setw(10)<<(parallel ? "parallel" : "serial")
+               <<std::setw(12)<<meshTime<<std::setw(12)<<initTime<<std::setw(12)<<updateTime
+               <<std::setw(14)<<(meshTime+initTime)*1e6/F.rows()<<std::endl;
+    }
+  }
+  return 0;
+}
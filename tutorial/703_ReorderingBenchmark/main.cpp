@@ -0,0 +1,63 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <Eigen/Core>
+#include <directional/TriMesh.h>
+#include <directional/IntrinsicFaceTangentBundle.h>
+#include <directional/CartesianField.h>
+#include <directional/power_field.h>
+#include <directional/power_to_raw.h>
+#include <directional/principal_matching.h>
+#include "benchmark_mesh.h"
+
+/***
+ Times a field-design pipeline (mesh and bundle construction, a power-field solve, and principal matching) on a mesh with shuffled elements,
+ with and without reordering the elements for locality (TriMesh::elementOrder).
+ Usage: 703_ReorderingBenchmark_bin [millions of faces] (default: 1)
+ ***/
+
+int main(int argc, char *argv[])
+{
+  const int N=4;
+  const double megaFaces=(argc>1 ? std::stod(argv[1]) : 1.0);
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  benchmark_mesh((int)(megaFaces*1e6), true, V, F);
+  std::cout<<F.rows()<<" faces, with shuffled vertices and faces"<<std::endl;
+
+  const directional::elementOrderTypeEnum orders[3]={directional::elementOrderTypeEnum::INPUT, directional::elementOrderTypeEnum::BFS, directional::elementOrderTypeEnum::MORTON};
+  const std::string orderNames[3]={"INPUT", "BFS", "MORTON"};
+  std::cout<<std::setw(10)<<"order"<<std::setw(12)<<"set_mesh"<<std::setw(12)<<"init"<<std::setw(12)<<"solve"<<std::setw(12)<<"matching"<<std::endl;
+  for (int i=0;i<3;i++){
+    directional::TriMesh mesh;
+    directional::IntrinsicFaceTangentBundle ftb;
+    directional::CartesianField powerField, field;
+    mesh.elementOrder=orders[i];
+
+    auto start=std::chrono::steady_clock::now();
+    mesh.set_mesh(V,F);
+    const double meshTime=benchmark_seconds(start);
+
+    start=std::chrono::steady_clock::now();
+    ftb.init(mesh);
+    const double initTime=benchmark_seconds(start);
+
+    //the same constraint (on input face 0) for all orders
+    int constFace=0;
+    while (mesh.faceOrder(constFace)!=0)
+      constFace++;
+    Eigen::VectorXi constFaces(1); constFaces(0)=constFace;
+    Eigen::MatrixXd constVectors(1,3); constVectors.row(0)=mesh.V.row(mesh.F(constFace,1))-mesh.V.row(mesh.F(constFace,0));
+    start=std::chrono::steady_clock::now();
+    directional::power_field(ftb, constFaces, constVectors, Eigen::VectorXd::Constant(1,-1.0), N, powerField);
+    directional::power_to_raw(powerField, N, field, true);
+    const double solveTime=benchmark_seconds(start);
+
+    start=std::chrono::steady_clock::now();
+    directional::principal_matching(field);
+    const double matchingTime=benchmark_seconds(start);
+
+    std::cout<<std::setw(10)<<orderNames[i]<<std::setw(12)<<meshTime<<std::setw(12)<<initTime<<std::setw(12)<<solveTime<<std::setw(12)<<matchingTime<<std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <cstdlib>
+#include <limits>
+#include <Eigen/Core>
+#include <igl/default_num_threads.h>
+#include <directional/TriMesh.h>
+#include <directional/IntrinsicFaceTangentBundle.h>
+#include <directional/CartesianField.h>
+#include <directional/principal_matching.h>
+#include <directional/curl_matching.h>
+#include "benchmark_mesh.h"
+
+/***
+ Times principal_matching() and curl_matching() serially (parallel=false) and in parallel, for a range of thread counts.
+ The number of threads of igl::parallel_for can only be set once per process, so every thread count is timed by running this program again.
+ Usage: 704_MatchingBenchmark_bin [millions of faces] [threads] (default: 1M faces, and all thread counts 1,2,4,... up to the number of cores)
+ ***/
+
+//The minimum of a few runs, to filter out the noise
+template<typename Function>
+double best_time(const Function& function)
+{
+  double bestTime=std::numeric_limits<double>::max();
+  for (int i=0;i<5;i++){
+    auto start=std::chrono::steady_clock::now();
+    function();
+    bestTime=std::min(bestTime, benchmark_seconds(start));
+  }
+  return bestTime;
+}
+
+int main(int argc, char *argv[])
+{
+  const int N=4;
+  const std::string megaFaces=(argc>1 ? argv[1] : "1");
+
+  if (argc<=2){
+    const int maxThreads=std::max(1u, std::thread::hardware_concurrency());
+    std::cout<<std::setw(10)<<"threads"<<std::setw(14)<<"principal"<<std::setw(14)<<"(serial)"<<std::setw(14)<<"curl"<<std::setw(14)<<"(serial)"<<std::endl;
+    for (int threads=1;threads<2*maxThreads;threads*=2){
+      const std::string command="\""+std::string(argv[0])+"\" "+megaFaces+" "+std::to_string(std::min(threads, maxThreads));
+      if (std::system(command.c_str())!=0)
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  const int threads=std::stoi(argv[2]);
+  igl::default_num_threads(threads);
+
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  benchmark_mesh((int)(std::stod(megaFaces)*1e6), false, V, F);
+  directional::TriMesh mesh;
+  directional::IntrinsicFaceTangentBundle ftb;
+  mesh.set_mesh(V,F);
+  ftb.init(mesh);
+
+  //a smoothly rotating (CCW-ordered) N-RoSy field
+  Eigen::MatrixXcd intField(F.rows(),N);
+  for (int i=0;i<F.rows();i++)
+    for (int j=0;j<N;j++)
+      intField(i,j)=std::polar(1.0, 3.0*mesh.barycenters(i,2)+mesh.barycenters(i,0)+2.0*igl::PI*j/N);
+  directional::CartesianField field;
+  field.init(ftb, directional::fieldTypeEnum::RAW_FIELD, N);
+  field.set_intrinsic_field(intField);
+
+  Eigen::VectorXd curlNorm;
+  const double principalParallel=best_time([&](){directional::principal_matching(field, true);});
+  const double principalSerial=best_time([&](){directional::principal_matching(field, false);});
+  const double curlParallel=best_time([&](){directional::curl_matching(field, curlNorm, true);});
+  const double curlSerial=best_time([&](){directional::curl_matching(field, curlNorm, false);});
+
+  std::cout<<std::setw(10)<<threads<<std::setw(14)<<principalParallel<<std::setw(14)<<principalSerial<<std::setw(14)<<curlParallel<<std::setw(14)<<curlSerial<<std::endl;
+  return EXIT_SUCCESS;
+}
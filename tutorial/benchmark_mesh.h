@@ -0,0 +1,63 @@
+#ifndef benchmark_mesh_h_included
+#define benchmark_mesh_h_included
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <Eigen/Core>
+#include <igl/PI.h>
+
+//Seconds since start, for the benchmarks of chapter 7
+inline double benchmark_seconds(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+//A noisy torus of (about) numFaces triangles, so that the benchmarks can be run at any scale without large mesh files.
+//The grid order of the elements has perfect locality; with shuffle, the vertices and faces are randomly permuted, as for meshes coming out of other tools.
+inline void benchmark_mesh(const int numFaces, const bool shuffle, Eigen::MatrixXd& V, Eigen::MatrixXi& F)
+{
+  const int m=std::max(3, (int)std::round(std::sqrt(numFaces/6.0)));
+  const int n=std::max(3, (int)std::round(numFaces/(2.0*m)));
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> noise(-0.2,0.2);
+
+  V.resize(n*m,3);
+  for (int i=0;i<n;i++)
+    for (int j=0;j<m;j++){
+      const double a=2.0*igl::PI*(i+noise(generator))/n, b=2.0*igl::PI*(j+noise(generator))/m;
+      V.row(i*m+j)<<(3.0+std::cos(b))*std::cos(a), (3.0+std::cos(b))*std::sin(a), std::sin(b);
+    }
+
+  F.resize(2*n*m,3);
+  for (int i=0;i<n;i++)
+    for (int j=0;j<m;j++){
+      const int v00=i*m+j, v10=((i+1)%n)*m+j, v11=((i+1)%n)*m+(j+1)%m, v01=i*m+(j+1)%m;
+      F.row(2*(i*m+j))<<v00,v10,v11;
+      F.row(2*(i*m+j)+1)<<v00,v11,v01;
+    }
+
+  if (!shuffle)
+    return;
+
+  std::vector<int> vertexPerm(V.rows()), facePerm(F.rows());
+  for (int i=0;i<vertexPerm.size();i++)
+    vertexPerm[i]=i;
+  for (int i=0;i<facePerm.size();i++)
+    facePerm[i]=i;
+  std::shuffle(vertexPerm.begin(), vertexPerm.end(), generator);
+  std::shuffle(facePerm.begin(), facePerm.end(), generator);
+  Eigen::MatrixXd shuffledV(V.rows(),3);
+  Eigen::MatrixXi shuffledF(F.rows(),3);
+  for (int i=0;i<V.rows();i++)
+    shuffledV.row(vertexPerm[i])=V.row(i);
+  for (int i=0;i<F.rows();i++)
+    for (int j=0;j<3;j++)
+      shuffledF(facePerm[i],j)=vertexPerm[F(i,j)];
+  V=shuffledV;
+  F=shuffledF;
+}
+
+#endif